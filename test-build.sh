@@ -1,23 +1,27 @@
 #!/bin/bash
 
 INCLUDE=""
-DEFINES="-DZTGL_IMPLEMENTATION -DZTGL_SDL2_RENDERER"
+DEFINES="-DZTGL_IMPLEMENTATION"
 WARNINGS="-Wall -Wextra -Wshadow"
 LIBRARIES="$(pkg-config --cflags sdl2 SDL2_ttf)"
 FLAGS="-std=c++20 -pedantic -fno-rtti -fno-exceptions"
 
 CPP=g++
 FLAGSFULL="$INCLUDE $DEFINES $WARNINGS $FLAGS $LIBRARIES"
+BACKENDS="-DZTGL_SDL2_RENDERER -UZTGL_SDL2_RENDERER"
 
 echo "[$0] test-build: copying" >&2
 cp ztgl.hh ztgl.cc
 
-echo "[$0] test-build: compilation" >&2
-$CPP -o ztgl.o -c ztgl.cc $FLAGSFULL
-if [ $? -ne 0 ]
-then
-	echo "[$0] test-build: failed to compile!" >&2
-	exit 1
-fi
+for BACKEND in $BACKENDS
+do
+	echo "[$0] test-build: compilation ($BACKEND)" >&2
+	$CPP -o ztgl.o -c ztgl.cc $FLAGSFULL $BACKEND
+	if [ $? -ne 0 ]
+	then
+		echo "[$0] test-build: failed to compile!" >&2
+		exit 1
+	fi
+done
 
 echo "[$0] test-build: finished successfully" >&2
@@ -86,6 +86,41 @@ constexpr usize       MEMORY_ALIGN      = 16;
 constexpr usize       MAX_OPTION_KEY    = 128;
 constexpr usize       MAX_OPTION_VALUE  = 128;
 constexpr const char* OPTION_SCAN       = "%127s = %127[^\r\n]";
+constexpr usize       FRAME_HISTORY     = 64;
+constexpr usize       MAX_TEXT_INPUT    = 256;  // bytes per frame
+constexpr usize       MAX_INPUT_EVENTS  = 1024; // must be a power of two
+constexpr usize       MAX_FRAME_EVENTS  = 128;
+constexpr usize       MAX_KEYS          = 1024; // key state bits, see KeyIndex
+constexpr usize       MAX_ACTIONS       = 256;
+constexpr usize       MAX_CHORD_KEYS    = 4;
+
+// platform constants
+constexpr i32         GLYPH_ATLAS_SIZE    = 1024;
+constexpr usize       MAX_ATLAS_GLYPHS    = 2048; // must be a power of two
+constexpr usize       MAX_TEXT_GLYPHS     = 256;
+constexpr usize       MAX_CACHED_TEXTS    = 512;
+constexpr usize       CACHED_TEXT_LENGTH  = 64;   // bytes, longer strings use the glyph atlas
+constexpr usize       MAX_BATCH_RECTS     = 4096;
+constexpr usize       MAX_CLIP_DEPTH      = 16;
+constexpr usize       BATCH_LOOKBACK      = 32;
+constexpr usize       MAX_BATCH_SPRITES   = 2048;
+constexpr usize       MAX_DRAW_GROUPS     = 1024;
+constexpr usize       MAX_SOFT_CMDS       = 8192;
+constexpr usize       MAX_RASTER_THREADS  = 16;
+constexpr usize       MAX_GLYPH_JOBS      = 256;
+constexpr usize       MAX_GLYPH_RESULTS   = 1024;
+constexpr usize       GLYPH_UPLOADS       = 64;   // per text draw
+
+// ui constants
+constexpr usize       MAX_MEASURED_FONTS  = 8;
+constexpr usize       MAX_TEXT_SIZES      = 1024; // must be a power of two
+constexpr usize       MIN_ARENA_ELEMS     = 16;
+constexpr usize       MAX_LAYOUT_DEPTH    = 32;
+constexpr usize       MAX_GRID_COLUMNS    = 32;
+constexpr i32         LIST_WHEEL_ROWS     = 3;
+constexpr usize       MAX_ID_DEPTH        = 32;
+constexpr usize       MAX_FRAME_PANELS    = 16;
+constexpr usize       LIST_OVERSCAN       = 2;    // rows past either edge
 
 // UI colors
 constexpr SDL_Color DEFAULT_COLORS[]  =
@@ -119,6 +154,11 @@ constexpr SDL_Color DEFAULT_COLORS[]  =
   {128, 128,  128,  255}, // textfield prompt
   {128, 128,  128,  255}, // textfield press prompt
   {128, 128,  128,  255}, // textfield hover prompt
+  {0,   0,    0,    128}, // list
+  {128, 128,  128,  128}, // list hover row
+  {128, 128,  128,  255}, // list selected row
+  {255, 255,  255,  255}, // list text
+  {128, 128,  128,  255}, // list bar
   {0,   0,    0,    128}  // inactive
 };
 
@@ -132,7 +172,43 @@ enum ErrorCode : u8
   OK  = 0,
   NOT_FOUND,
   INVALID_FORMAT,
-  INVALID_CONVERSION
+  INVALID_CONVERSION,
+  WRITE_FAILED,
+  OUT_OF_SPACE
+};
+
+enum LayoutType : u8
+{
+  LAYOUT_ROW = 0,
+  LAYOUT_COLUMN,
+  LAYOUT_GRID,
+  LAYOUT_LEAF
+};
+
+enum LayoutAlign : u8
+{
+  ALIGN_START = 0,
+  ALIGN_CENTER,
+  ALIGN_END,
+  ALIGN_FILL
+};
+
+enum InputEventType : u8
+{
+  INPUT_KEY_DOWN = 0,
+  INPUT_KEY_UP,
+  INPUT_MOUSE_DOWN,
+  INPUT_MOUSE_UP,
+  INPUT_MOUSE_MOTION,
+  INPUT_MOUSE_WHEEL
+};
+
+enum Easing : u8
+{
+  EASE_LINEAR = 0,
+  EASE_IN,
+  EASE_OUT,
+  EASE_IN_OUT
 };
 
 enum Color : u8
@@ -166,6 +242,11 @@ enum Color : u8
   TEXT_FIELD_PROMPT_COLOR,
   TEXT_FIELD_PROMPT_PRESS_COLOR,
   TEXT_FIELD_PROMPT_HOVER_COLOR,
+  LIST_COLOR,
+  LIST_ROW_HOVER_COLOR,
+  LIST_ROW_SELECTED_COLOR,
+  LIST_TEXT_COLOR,
+  LIST_BAR_COLOR,
   INACTIVE_COLOR
 };
 
@@ -173,6 +254,8 @@ enum Color : u8
 // standalone data structures //
 //----------------------------//
 
+struct BumpAllocator;
+
 struct Conf
 {
   // library function config
@@ -181,10 +264,17 @@ struct Conf
   u64         m_TickMicro;
   i32         m_UIPad;
   i32         m_UITextFieldBar;
+  i32         m_UIScrollBar;  // 0 scrolls lists with the wheel only
+  BumpAllocator* m_TextArena; // optional, backs LabelF() and the like, reset by BeginTick
   
   // rendering call config
   void        (*m_RenderRect)(i32, i32, i32, i32, Color);
   void        (*m_RenderText)(i32, i32, i32, i32, const char*, Color);
+  void        (*m_SetClip)(const SDL_Rect*); // optional, nullptr disables clip
+  
+  // optional, set to Platform::RenderTextRun to draw a text run in one call.
+  // left unset, every codepoint is a separate m_RenderText call.
+  void        (*m_RenderTextRun)(i32, i32, i32, i32, const char*, usize, Color);
 };
 
 struct PlatformConf
@@ -192,6 +282,17 @@ struct PlatformConf
 #ifdef  ZTGL_SDL2_RENDERER
   SDL_Renderer* m_Renderer;
   TTF_Font*     m_Font;
+  usize         m_TextCacheBudget;  // texture bytes, 0 disables string caching
+  bool          m_BatchRects;       // queue rects until Platform::Flush()
+#else
+  // software rendering into a caller-owned framebuffer, with pixels laid
+  // out as SDL_PIXELFORMAT_RGBA32. drawing is deferred to Platform::Flush()
+  u32*          m_Pixels;
+  i32           m_Width;
+  i32           m_Height;
+  i32           m_Pitch;            // in pixels
+  TTF_Font*     m_Font;
+  u32           m_Threads;          // horizontal bands rendered in parallel
 #endif
 };
 
@@ -201,7 +302,191 @@ struct Resource
   u32&  m_Size;
 };
 
+struct DrawCmd
+{
+  const char* m_Text;
+  i32         m_X;
+  i32         m_Y;
+  i32         m_W;
+  i32         m_H;
+  u32         m_Length; // text runs only, in bytes
+  u32         m_Next;
+  u16         m_Clip;
+  u8          m_Type;
+  Color       m_Color;
+};
+
+// stamped with SDL_GetPerformanceCounter() by HandleInput, or when SDL
+// queues it after WatchInput()
+struct InputEvent
+{
+  u64 m_Time;
+  i32 m_Code;   // SDL_Keycode or mouse button
+  i32 m_X;      // mouse position, buttons and motion only
+  i32 m_Y;
+  i32 m_DeltaX; // relative motion, or horizontal wheel steps
+  i32 m_DeltaY; // relative motion, or vertical wheel steps
+  u16 m_Mod;    // keys only
+  u8  m_Type;   // InputEventType
+};
+
+// input of one frame, see UIPipeline
+struct InputState
+{
+  u8          m_KeyDown[MAX_KEYS / 8];
+  u8          m_KeyPress[MAX_KEYS / 8];
+  u8          m_KeyRelease[MAX_KEYS / 8];
+  u8          m_MouseDown;
+  u8          m_MousePress;
+  u8          m_MouseRelease;
+  u16         m_Mod;
+  
+  // text typed this frame, in order and null terminated
+  char        m_Text[MAX_TEXT_INPUT];
+  usize       m_TextLength;
+  
+  // mouse snapshot, taken by PrepareInput and kept current by HandleInput
+  SDL_Window* m_MouseFocus;
+  i32         m_MouseX;
+  i32         m_MouseY;
+  i32         m_MouseDeltaX;
+  i32         m_MouseDeltaY;
+  i32         m_MouseWheel;
+  
+  // input events of this frame in order, with consecutive motion or wheel
+  // events merged into one
+  InputEvent  m_Events[MAX_FRAME_EVENTS];
+  usize       m_EventsLength;
+};
+
+// keys that have to be held together for an action, as (word, mask) pairs
+// over the key state seen as 64-bit words, see ActionMap
+struct ActionChord
+{
+  u64 m_Masks[MAX_CHORD_KEYS];
+  u8  m_Words[MAX_CHORD_KEYS];
+  u8  m_Length;
+  u16 m_Action;
+};
+
+// counters for one frame, reset by BeginTick and recorded by EndTick
+struct FrameStats
+{
+  u64 m_Micro;            // BeginTick to EndTick, without the delay
+  u32 m_DrawCalls;        // renderer submissions, or software raster passes
+  u32 m_ColorChanges;
+  u32 m_TexturesCreated;
+  u32 m_Rasterizations;   // glyphs and strings rendered by SDL_ttf
+  u32 m_Measurements;     // SDL_ttf size queries
+  u32 m_Rects;
+  u32 m_Texts;
+  u32 m_Sprites;
+  u32 m_PanelRenders;
+  u32 m_PanelCacheHits;
+  u32 m_Widgets;
+};
+
+// retained render target for a UIPanel, see UIPanel::m_Cache
+struct PanelCache
+{
+  u64           m_Hash;
+  SDL_Texture*  m_Texture;
+  i32           m_W;
+  i32           m_H;
+};
+
+// textured quad for Platform::RenderSprite
+struct Sprite
+{
+  SDL_Texture*  m_Texture;
+  SDL_Rect      m_Src;    // in texels, zero size uses the whole texture
+  f32           m_X;
+  f32           m_Y;
+  f32           m_W;
+  f32           m_H;
+  f32           m_Angle;  // degrees clockwise around the center
+  SDL_Color     m_Tint;
+};
+
+// m_W, m_H and m_ID are filled by the caller, the rest by PackRects
+struct AtlasRect
+{
+  i32 m_W;
+  i32 m_H;
+  i32 m_X;
+  i32 m_Y;
+  i32 m_Page; // -1 if the rect does not fit into a page
+  u32 m_ID;
+};
+
+// scroll and selection of a UIPanel::List, kept by the caller across frames
+struct ListState
+{
+  i32   m_Scroll;       // in pixels
+  usize m_Selected;
+  bool  m_HasSelection;
+};
+
+// optional structure-of-arrays copy of UIPanel element geometry, with
+// every array holding as many entries as the panel's m_Elems
+struct UIElemArrays
+{
+  i32*  m_X;
+  i32*  m_Y;
+  i32*  m_W;
+  i32*  m_H;
+  u8*   m_Type;
+  u16*  m_Flags;
+};
+
+struct LayoutStyle
+{
+  i32 m_MinW;
+  i32 m_MinH;
+  i32 m_MaxW;     // 0 for unbounded
+  i32 m_MaxH;     // 0 for unbounded
+  i32 m_Gap;      // between children
+  i32 m_Pad;      // around children
+  u16 m_Columns;  // grids only
+  u8  m_Align;    // LayoutAlign, of children across the layout direction (grids: both),
+                  // widgets may override it for themselves
+};
+
+// cached layout state of a container or widget, see Layout
+struct LayoutNode
+{
+  u64         m_ID;
+  u64         m_Inputs; // hash of everything the solution depends on
+  u64         m_Solved; // m_Inputs when last solved, 0 if never
+  SDL_Rect    m_Cell;   // space given by the parent when last solved
+  SDL_Rect    m_Rect;
+  LayoutStyle m_Style;
+  i32         m_PrefW;
+  i32         m_PrefH;
+  u32         m_Frame;
+  u32         m_Parent;
+  u32         m_FirstChild;
+  u32         m_LastChild;
+  u32         m_Next;
+  u32         m_Count;
+  u32         m_Elem;
+  u8          m_Type;
+  u8          m_CellAlign;
+};
+
+// persistent state of one widget, see WidgetStore
+struct WidgetState
+{
+  u64   m_ID;
+  u64   m_TextHash; // of the text and font m_TextW and m_TextH were measured for
+  i32   m_TextW;
+  i32   m_TextH;
+  u32   m_Frame;    // last frame the widget was seen
+  bool  m_Pressed;  // mouse went down over the widget and is still held
+};
+
 struct TFData;
+struct TextModel;
 
 union UIElem
 {
@@ -262,6 +547,44 @@ union UIElem
     const char*   m_Text;
     const TFData* m_TFData;
   }               m_TextField;
+  
+  struct
+  {
+    u8                m_Type;
+    u16               m_Flags;
+    i32               m_X;
+    i32               m_Y;
+    i32               m_W;
+    i32               m_H;
+    u32               m_Cols;
+    u32               m_Rows;
+    const char*       m_Text;
+    const TextModel*  m_Model;
+  }                   m_TextEditor;
+  
+  struct
+  {
+    u8            m_Type;
+    u16           m_Flags;
+    i32           m_X;
+    i32           m_Y;
+    i32           m_W;
+    i32           m_H;
+    i32           m_RowH;
+    usize         m_Count;
+    ListState*    m_State;
+    const char*   (*m_Row)(usize, void*);
+    void*         m_Userdata;
+  }               m_List;
+};
+
+struct TextCacheStats
+{
+  u64   m_Hits;
+  u64   m_Misses;
+  u64   m_Evictions;
+  usize m_Bytes;
+  usize m_Entries;
 };
 
 struct AllocBatchDesc
@@ -289,7 +612,87 @@ struct Allocation
 // data structures with methods //
 //------------------------------//
 
+// rendering
+struct DrawList
+{
+  DrawCmd*  m_Cmds          {};
+  usize     m_CmdsLength    {};
+  usize     m_CmdsCapacity  {};
+  SDL_Rect* m_Clips         {};
+  usize     m_ClipsLength   {};
+  usize     m_ClipsCapacity {};
+  u16       m_Clip          {};
+  
+  // translates everything drawn afterwards
+  i32       m_OffsetX       {};
+  i32       m_OffsetY       {};
+  
+  // nested clips, each intersected with the one it was pushed inside of
+  SDL_Rect  m_ClipStack[MAX_CLIP_DEPTH] {};
+  usize     m_ClipDepth     {};
+  
+  void      Rect(i32 x, i32 y, i32 w, i32 h, Color color);
+  void      Text(i32 x, i32 y, i32 w, i32 h, const char* text, Color color);
+  void      TextRun(i32 x, i32 y, i32 advance, i32 h, const char* text, usize length, Color color);
+  void      SetClip(const SDL_Rect* clip);
+  void      PushClip(const SDL_Rect& clip);
+  void      PopClip();
+  bool      Visible(i32 x, i32 y, i32 w, i32 h) const;
+  void      Submit();
+  void      Replay() const;
+  void      Clear();
+  
+  // default constructed draw lists forward straight to g_Conf callbacks
+  DrawList() = default;
+  DrawList(DrawCmd cmds[], usize cmdsCapacity, SDL_Rect clips[], usize clipsCapacity);
+};
+
 // ui
+// nodes are kept in caller storage across frames, keyed by ID. a container
+// whose inputs and given space did not change keeps last frame's solution
+// for its whole subtree, widgets simply reuse their cached rects.
+struct Layout
+{
+  LayoutNode* m_Nodes                   {};
+  usize       m_NodesLength             {};
+  usize       m_NodesCapacity           {}; // must be a power of two
+  u32         m_Frame                   {1};
+  u32         m_Stack[MAX_LAYOUT_DEPTH] {};
+  usize       m_StackLength             {};
+  i32         m_RootX                   {};
+  i32         m_RootY                   {};
+  LayoutStyle m_NextStyle               {};
+  
+  void        BeginFrame();
+  
+  Layout() = default;
+  Layout(LayoutNode nodes[], usize nodesCapacity);
+};
+
+// widget state kept across frames in caller storage, keyed by the hash of
+// the widget's text under the current ID scope. widgets which were not
+// seen during a frame are evicted by the following BeginFrame()
+struct WidgetStore
+{
+  WidgetState*  m_States                {};
+  usize         m_StatesLength          {};
+  usize         m_StatesCapacity        {}; // must be a power of two
+  u32           m_Frame                 {1};
+  u64           m_IDStack[MAX_ID_DEPTH] {};
+  usize         m_IDStackLength         {};
+  
+  void          PushID(u64 id);
+  void          PushID(const char* str);
+  void          PopID();
+  u64           ID(const char* label) const;
+  WidgetState*  Get(u64 id);
+  void          BeginFrame();
+  
+  WidgetStore() = default;
+  WidgetStore(WidgetState states[], usize statesCapacity);
+  WidgetStore(BumpAllocator& arena, usize statesCapacity);
+};
+
 struct TFData
 {
   char* m_Buffer    {};
@@ -303,6 +706,42 @@ struct TFData
   TFData(char buffer[], usize capacity);
 };
 
+// gap buffer text for UIPanel::TextEditor. edits happen at the gap, which
+// follows the cursor, and the line index keeps starts past the cursor
+// relative to the end of text, so that a keystroke costs the same at any
+// buffer size. offsets are logical, i.e. they skip the gap
+struct TextModel
+{
+  char*   m_Buffer        {};
+  usize   m_Capacity      {};
+  usize   m_GapStart      {};
+  usize   m_GapEnd        {};
+  usize*  m_Lines         {}; // starts of lines after the first
+  usize   m_LinesCapacity {};
+  usize   m_LinesBefore   {}; // at the front of m_Lines, absolute
+  usize   m_LinesAfter    {}; // at the back of m_Lines, from end of text
+  usize   m_Cursor        {};
+  usize   m_FirstLine     {};
+  usize   m_FirstColumn   {};
+  bool    m_Selected      {};
+  
+  usize   Length() const;
+  usize   Lines() const;
+  usize   LineStart(usize line) const;
+  usize   LineLength(usize line) const;
+  usize   LineOf(usize offset) const;
+  char    At(usize offset) const;
+  usize   Read(usize offset, OUT char dst[], usize n) const;
+  bool    Insert(char c);
+  bool    Insert(const char* str);
+  bool    Erase();  // before the cursor
+  bool    Delete(); // after the cursor
+  void    Clear();
+  
+  TextModel() = default;
+  TextModel(char buffer[], usize capacity, usize lines[], usize linesCapacity);
+};
+
 struct UIPanel
 {
   UIElem*           m_Elems         {};
@@ -310,21 +749,39 @@ struct UIPanel
   usize             m_ElemsCapacity {};
   TTF_Font*         m_Font          {};
   const SDL_Window* m_Window        {};
+  UIElemArrays      m_Arrays        {};
+  BumpAllocator*    m_Arena         {}; // grows elements instead of dropping
+  Layout*           m_Layout        {}; // call BeginFrame() on it every frame
+  WidgetStore*      m_Store         {}; // call BeginFrame() on it every frame
   
   // can safely be modified by end user
   i32               m_X             {};
   i32               m_Y             {};
   bool              m_Active        {true};
   bool              m_Horizontal    {};
+  PanelCache*       m_Cache         {}; // requires platform render callbacks
+  SDL_Rect          m_Clip          {}; // empty for none
   
   void              Render();
+  void              Render(DrawList& list);
   void              Label(const char* text);
   bool              Button(const char* text);
   bool              Slider(const char* text, IN_OUT f32& value);
   bool              TextField(const char* text, IN_OUT TFData& data, u32 nDraw);
   bool              HoldButton(const char* text);
+  void              LabelF(const char* format, ...);
+  bool              ButtonF(const char* format, ...);
+  bool              SliderF(IN_OUT f32& value, const char* format, ...);
+  bool              HoldButtonF(const char* format, ...);
+  bool              TextEditor(const char* text, IN_OUT TextModel& model, u32 cols, u32 rows);
+  bool              List(IN_OUT ListState& state, usize count, i32 rowH, i32 w, i32 h, const char* (*row)(usize, void*), void* userdata);
+  void              BeginLayout(u64 id, LayoutType type, const LayoutStyle& style);
+  void              EndLayout();
+  void              NextLayoutStyle(const LayoutStyle& style);
   
   UIPanel(UIElem elems[], usize elemsCapacity, TTF_Font* font, SDL_Window const* window);
+  UIPanel(UIElem elems[], const UIElemArrays& arrays, usize elemsCapacity, TTF_Font* font, SDL_Window const* window);
+  UIPanel(BumpAllocator& arena, usize elemsCapacity, bool arrays, TTF_Font* font, SDL_Window const* window);
 };
 
 // memory management
@@ -362,6 +819,92 @@ struct ArrayAllocator
   ArrayAllocator(u8* buffer, usize bufferCapacity, Allocation* allocations, usize allocationsCapacity);
 };
 
+// pipelined ui
+// one frame of UI, see UIPipeline
+struct UIFrame
+{
+  BumpAllocator m_Arena                     {nullptr, 0}; // given its buffer by UIPipeline
+  UIPanel*      m_Panels[MAX_FRAME_PANELS]  {};
+  usize         m_PanelsLength              {};
+  InputState    m_Input                     {};
+  FrameStats    m_Stats                     {};
+};
+
+// builds UI on a worker thread while the main thread renders the frame
+// before it. the worker wraps its widget calls in BeginBuild() and
+// EndBuild(), the main thread calls Swap() after handling input and then
+// Render(). everything a frame shows is copied into its arena when it is
+// built, widgets may keep changing their data right after
+struct UIPipeline
+{
+  UIFrame     m_Frames[2];
+  u32         m_Build       {}; // frame being built by the worker
+  SDL_sem*    m_Free        {}; // nullptr if the constructor failed
+  SDL_sem*    m_Built       {};
+  TTF_Font*   m_Font        {}; // for rendering on the main thread
+  TTF_Font*   m_WorkerFont  {}; // for measuring on the worker, not m_Font
+  
+  void        BeginBuild();
+  UIPanel*    Panel(const SDL_Window* window, usize elemsCapacity);
+  void        EndBuild();
+  void        Swap();
+  void        Render();
+  void        Release();
+  
+  UIPipeline() = default;
+  UIPipeline(u8* buffer, usize capacity, TTF_Font* font, TTF_Font* workerFont);
+};
+
+// animation
+// moves f32 values, e.g. positions, colors or angles, to an end value over
+// a number of seconds. every tween is advanced by one pass over the arrays
+// per Update(), and a finished one is replaced by the last
+struct Tweens
+{
+  f32*    m_Start     {};
+  f32*    m_End       {};
+  f32*    m_Time      {}; // seconds since the tween was added
+  f32*    m_Duration  {};
+  u32*    m_Easing    {}; // 32-bit to load alongside the floats
+  f32**   m_Target    {};
+  usize   m_Length    {};
+  usize   m_Capacity  {};
+  
+  bool    Add(f32* target, f32 end, f32 duration, Easing easing);
+  bool    AddAngle(f32* target, f32 end, f32 duration, Easing easing);
+  void    Cancel(const f32* target);
+  void    Update(f32 dt);
+  void    Clear();
+  
+  Tweens() = default;
+  Tweens(BumpAllocator& arena, usize capacity);
+};
+
+// input
+// key bindings compiled down to masks over the key state. an action has any
+// number of chords, alternatives, and a chord up to MAX_CHORD_KEYS keys that
+// are held together. Update() evaluates all actions once per frame
+struct ActionMap
+{
+  ActionChord*  m_Chords                        {};
+  usize         m_ChordsLength                  {};
+  usize         m_ChordsCapacity                {};
+  u64           m_Down[MAX_ACTIONS / 64]        {};
+  u64           m_Pressed[MAX_ACTIONS / 64]     {};
+  u64           m_Released[MAX_ACTIONS / 64]    {};
+  
+  bool          Bind(u16 action, const SDL_Keycode keys[], usize n);
+  ErrorCode     Bind(u16 action, FILE* file, const char* key);
+  void          Unbind(u16 action);
+  void          Update();
+  bool          Down(u16 action) const;
+  bool          Pressed(u16 action) const;
+  bool          Released(u16 action) const;
+  
+  ActionMap() = default;
+  ActionMap(ActionChord chords[], usize chordsCapacity);
+};
+
 //-------------------------------//
 // dynamic library configuration //
 //-------------------------------//
@@ -380,13 +923,28 @@ bool      KeyDown(SDL_Keycode key);
 bool      KeyPressed(SDL_Keycode key);
 bool      KeyReleased(SDL_Keycode key);
 SDL_Point MousePos(const SDL_Window* window);
+SDL_Point MouseDelta();
+i32       MouseWheel();
 bool      MouseDown(i32 button);
 bool      MousePressed(i32 button);
 bool      MouseReleased(i32 button);
 bool      TextInput(char c);
+const char* TypedText();
 bool      ShiftDown();
 bool      CtrlDown();
 bool      AltDown();
+const InputEvent* InputEvents(OUT usize& n);
+void      WatchInput();
+void      UnwatchInput();
+
+// rendering
+u32       PackRects(IN_OUT AtlasRect rects[], usize n, i32 w, i32 h, i32 pad);
+u32       BuildAtlas(SDL_Surface* const images[], OUT AtlasRect rects[], usize n, i32 w, i32 h, i32 pad, OUT SDL_Surface* pages[], u32 maxPages);
+ErrorCode SaveAtlas(const char* path, SDL_Surface* const pages[], u32 nPages, const char* const names[], const AtlasRect rects[], usize n);
+
+// ui
+void      TextSize(TTF_Font* font, const char* text, OUT i32& w, OUT i32& h);
+void      ForgetFonts();
 
 // options
 ErrorCode OptionRaw(OUT char data[], FILE* file, const char* key);
@@ -394,6 +952,7 @@ ErrorCode OptionKeycode(OUT SDL_Keycode& data, FILE* file, const char* key);
 ErrorCode OptionFloat(OUT f32& data, FILE* file, const char* key);
 ErrorCode OptionInt(OUT i64& data, FILE* file, const char* key);
 ErrorCode OptionBool(OUT bool& data, FILE* file, const char* key);
+ErrorCode OptionAtlasRect(OUT AtlasRect& data, FILE* file, const char* key);
 
 // util
 void  Error(const char* format, ...);
@@ -409,6 +968,8 @@ f32   Radians(f32 deg);
 void* AllocBatch(IN_OUT AllocBatchDesc allocs[], usize nAllocs);
 void* ReallocBatch(void* p, IN_OUT ReallocBatchDesc reallocs[], usize nReallocs);
 u64   Align(u64 addr, u64 align);
+u64   HashString(const char* str);
+bool  GetFrameStats(OUT FrameStats& stats, usize age);
 
 //------------------------------------------//
 // standalone platform-dependent procedures //
@@ -417,8 +978,25 @@ u64   Align(u64 addr, u64 align);
 namespace Platform
 {
 
-void  RenderRect(i32 x, i32 y, i32 w, i32 h, Color color);
-void  RenderText(i32 x, i32 y, i32 w, i32 h, const char* text, Color color);
+void            RenderRect(i32 x, i32 y, i32 w, i32 h, Color color);
+void            RenderText(i32 x, i32 y, i32 w, i32 h, const char* text, Color color);
+void            RenderTextRun(i32 x, i32 y, i32 advance, i32 h, const char* text, usize length, Color color);
+void            RenderRects(const SDL_Rect rects[], usize n, Color color);
+void            RenderSprite(const Sprite& sprite);
+void            RenderSprites(const Sprite sprites[], usize n);
+void            SetClip(const SDL_Rect* clip);
+void            Flush();
+bool            PrerasterizeText(TTF_Font* font, TTF_Font* workerFont, const char* const strings[], usize n);
+bool            PrerasterizeRange(TTF_Font* font, TTF_Font* workerFont, u32 first, u32 last);
+usize           UploadGlyphs();
+bool            PrerasterizePending();
+bool            BeginPanelCache(IN_OUT PanelCache& cache, i32 w, i32 h);
+void            EndPanelCache(const PanelCache& cache);
+void            RenderPanelCache(const PanelCache& cache, i32 x, i32 y);
+void            ReleasePanelCache(IN_OUT PanelCache& cache);
+void            ReleaseResources();
+TextCacheStats  GetTextCacheStats();
+void            ResetTextCacheStats();
 
 }
 
@@ -436,6 +1014,7 @@ void  RenderText(i32 x, i32 y, i32 w, i32 h, const char* text, Color color);
 #include <cstdarg>
 #include <cstdlib>
 #include <cstring>
+#include <new>
 
 // system dependencies
 extern "C"
@@ -443,6 +1022,13 @@ extern "C"
 #include <sys/time.h>
 }
 
+// vector extensions
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace ZTGL
 {
 
@@ -454,26 +1040,266 @@ enum UIFlag : u8
   INACTIVE  = 0x1
 };
 
+enum DrawType : u8
+{
+  DRAW_RECT = 0,
+  DRAW_TEXT,
+  DRAW_TEXT_RUN
+};
+
 enum UIType : u8
 {
   LABEL = 0,
   BUTTON,
   SLIDER,
   TEXT_FIELD,
-  HOLD_BUTTON
+  HOLD_BUTTON,
+  LIST,
+  TEXT_EDITOR,
+  UI_TYPES
 };
 
 // input
-u8  g_KeyDownStates[1024 / 8];
-u8  g_KeyPressStates[1024 / 8];
-u8  g_KeyReleaseStates[1024 / 8];
-u8  g_MouseDownStates;
-u8  g_MousePressStates;
-u8  g_MouseReleaseStates;
-u8  g_TextInputStates[128 / 8];
+// written by HandleInput and PrepareInput. queries read t_Input, which a
+// pipelined UI build points at its frame's own copy
+InputState                      g_Input;
+thread_local const InputState*  t_Input = &g_Input;
+
+// input events on their way from SDL to HandleInput
+InputEvent    g_InputEvents[MAX_INPUT_EVENTS];
+SDL_atomic_t  g_InputEventsHead;
+SDL_atomic_t  g_InputEventsTail;
+bool          g_InputWatched;
+
+// what did not fit in the ring. motion and wheel wait in one merged event
+// each, touched by the producer only. releases are kept as bits, keys
+// first and mouse buttons in the last word, for the consumer to pick up
+InputEvent    g_InputPendingMotion;
+InputEvent    g_InputPendingWheel;
+SDL_atomic_t  g_InputLostReleases[MAX_KEYS / 32 + 1];
+SDL_atomic_t  g_InputLost;
+
+// ui
+struct FontMetrics
+{
+  TTF_Font* m_Font;
+  i32       m_Advance;  // nonzero only for fixed width fonts
+  i32       m_Height;
+};
+
+struct TextSizeEntry
+{
+  TTF_Font*   m_Font;
+  const char* m_Text;
+  u64         m_Hash;
+  i32         m_W;
+  i32         m_H;
+};
+
+// sits right before the text of LabelF() and the like in the text arena.
+// m_Text points back at the text, so that it can be told apart from other
+// strings that happen to lie in the arena
+struct FormattedText
+{
+  u64         m_Hash; // of the text
+  u64         m_ID;   // of the format, stays put as the text changes
+  const char* m_Text;
+};
+
+// rows of a list as they were when its frame was built
+struct FrozenRows
+{
+  const char**  m_Texts;
+  usize         m_First;
+  usize         m_Count;
+};
+
+// per thread, so that UI built on a pipeline worker measures on its own
+thread_local FontMetrics    t_FontMetrics[MAX_MEASURED_FONTS];
+thread_local usize          t_FontMetricsNext;
+thread_local TextSizeEntry  t_TextSizes[MAX_TEXT_SIZES];
+thread_local i32            t_FontGeneration;
+
+// bumped by ForgetFonts(), each thread drops its measurements on seeing it
+SDL_atomic_t  g_FontGeneration;
+
+// formatted text goes here instead of g_Conf.m_TextArena when set, a
+// pipelined UI build points it at its frame's arena
+thread_local BumpAllocator* t_TextArena;
+
+// rendering
+struct DrawGroup
+{
+  SDL_Rect  m_Bounds;
+  u32       m_First;
+  u32       m_Last;
+  u16       m_Clip;
+  u8        m_Type;
+  Color     m_Color;
+};
+
+constexpr u16 NO_CLIP_STORAGE = UINT16_MAX;
+
+DrawGroup g_DrawGroups[MAX_DRAW_GROUPS];
 
 // util
-u64 g_TickStart;
+u64         g_TickStart;
+FrameStats  g_FrameStats;
+
+// counters go through here, a pipelined UI build counts into its frame
+thread_local FrameStats*  t_FrameStats  = &g_FrameStats;
+FrameStats  g_FrameHistory[FRAME_HISTORY];
+u64         g_FramesRecorded;
+
+// platform
+struct Glyph
+{
+  TTF_Font* m_Font;
+  u32       m_Codepoint;
+  i16       m_X;
+  i16       m_Y;
+  i16       m_W;
+  i16       m_H;
+  i32       m_Advance;
+};
+
+Glyph g_Glyphs[MAX_ATLAS_GLYPHS];
+usize g_GlyphsLength;
+i32   g_ShelfX;
+i32   g_ShelfY;
+i32   g_ShelfH;
+
+struct GlyphJob
+{
+  TTF_Font* m_Font;
+  TTF_Font* m_WorkerFont;
+  u32       m_First;
+  u32       m_Last;
+};
+
+struct GlyphResult
+{
+  TTF_Font*     m_Font;
+  SDL_Surface*  m_Surface;
+  u32           m_Codepoint;
+  i32           m_Advance;
+  bool          m_Valid;
+};
+
+GlyphJob      g_GlyphJobs[MAX_GLYPH_JOBS];
+SDL_atomic_t  g_GlyphJobsHead;
+SDL_atomic_t  g_GlyphJobsTail;
+GlyphResult   g_GlyphResults[MAX_GLYPH_RESULTS];
+SDL_atomic_t  g_GlyphResultsHead;
+SDL_atomic_t  g_GlyphResultsTail;
+SDL_atomic_t  g_GlyphsInFlight;
+SDL_atomic_t  g_GlyphWorkerQuit;
+SDL_sem*      g_GlyphJobsReady;
+SDL_Thread*   g_GlyphWorker;
+
+#ifdef ZTGL_SDL2_RENDERER
+SDL_Texture*  g_GlyphAtlas;
+SDL_Renderer* g_GlyphAtlasRenderer;
+SDL_Vertex    g_TextVertices[4 * MAX_TEXT_GLYPHS];
+i32           g_TextIndices[6 * MAX_TEXT_GLYPHS];
+usize         g_TextGlyphs;
+
+// cached strings form an LRU list through m_Prev / m_Next.
+struct CachedText
+{
+  TTF_Font*     m_Font;
+  u64           m_Hash;
+  SDL_Texture*  m_Texture;
+  usize         m_Bytes;
+  u16           m_Prev;
+  u16           m_Next;
+  Color         m_Color;
+  char          m_Text[CACHED_TEXT_LENGTH]; // compared on a hit, hashes can collide
+};
+
+constexpr u16 NO_TEXT = UINT16_MAX;
+
+CachedText      g_CachedTexts[MAX_CACHED_TEXTS];
+u16             g_CachedTextTable[2 * MAX_CACHED_TEXTS]; // entry index + 1
+u16             g_CachedTextFree[MAX_CACHED_TEXTS];
+usize           g_CachedTextFreeLength;
+u16             g_CachedTextHead  {NO_TEXT};
+u16             g_CachedTextTail  {NO_TEXT};
+SDL_Renderer*   g_TextCacheRenderer;
+TextCacheStats  g_TextCacheStats;
+
+// queued rects are grouped by color, a group only accepts a rect if no
+// later group overlaps it so that painter's order is kept.
+struct RectGroup
+{
+  SDL_Rect  m_Bounds;
+  u16       m_Length;
+  Color     m_Color;
+};
+
+SDL_Rect  g_BatchRects[MAX_BATCH_RECTS];
+u16       g_BatchRectGroups[MAX_BATCH_RECTS];
+usize     g_BatchRectsLength;
+RectGroup g_RectGroups[MAX_BATCH_RECTS];
+usize     g_RectGroupsLength;
+SDL_Rect  g_SortedRects[MAX_BATCH_RECTS];
+
+// sprites are grouped by texture the same way, with at most one of rects
+// and sprites queued at any time.
+struct SpriteGroup
+{
+  SDL_Rect      m_Bounds;
+  SDL_Texture*  m_Texture;
+  i32           m_TexW;
+  i32           m_TexH;
+  u16           m_Length;
+};
+
+SDL_Vertex  g_BatchSprites[4 * MAX_BATCH_SPRITES];
+u16         g_BatchSpriteGroups[MAX_BATCH_SPRITES];
+usize       g_BatchSpritesLength;
+SpriteGroup g_SpriteGroups[MAX_BATCH_SPRITES];
+usize       g_SpriteGroupsLength;
+SDL_Vertex  g_SortedSprites[4 * MAX_BATCH_SPRITES];
+i32         g_SpriteIndices[6 * MAX_BATCH_SPRITES];
+
+SDL_Texture*  g_PanelCachePrevTarget;
+#else
+enum SoftType : u8
+{
+  SOFT_RECT = 0,
+  SOFT_GLYPH
+};
+
+// m_Rect is already clipped, glyph coverage for a destination pixel (x, y)
+// is read from the atlas at (x + m_SrcX, y + m_SrcY).
+struct SoftCmd
+{
+  SDL_Rect  m_Rect;
+  i32       m_SrcX;
+  i32       m_SrcY;
+  u8        m_Type;
+  Color     m_Color;
+};
+
+struct RasterWorker
+{
+  SDL_Thread* m_Thread;
+  SDL_sem*    m_Start;
+  i32         m_Y0;
+  i32         m_Y1;
+};
+
+u8            g_CoverageAtlas[GLYPH_ATLAS_SIZE * GLYPH_ATLAS_SIZE];
+SoftCmd       g_SoftCmds[MAX_SOFT_CMDS];
+usize         g_SoftCmdsLength;
+SDL_Rect      g_SoftClip;
+bool          g_SoftClipped;
+RasterWorker  g_RasterWorkers[MAX_RASTER_THREADS];
+usize         g_RasterWorkersLength;
+SDL_sem*      g_RasterDone;
+bool          g_RasterQuit;
+#endif
 
 }
 
@@ -484,1088 +1310,6320 @@ PlatformConf  g_PlatformConf;
 // input //
 //-------//
 
-void  HandleInput(const SDL_Event& event)
+namespace Internal
 {
-  if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP)
-  {
-    if (event.key.repeat)
-    {
-      return;
-    }
-    
-    bool        state = event.type == SDL_KEYDOWN;
-    SDL_Keycode key   = event.key.keysym.sym;
-    if (key & 1 << 30)
-    {
-      key &= ~(1 << 30);
-      key += 128;
-    }
-    
-    usize byte  = key / 8;
-    usize bit   = key % 8;
-    
-    if (state)
-    {
-      Internal::g_KeyDownStates[byte] |= 1 << bit;
-      Internal::g_KeyPressStates[byte] |= 1 << bit;
-    }
-    else
-    {
-      Internal::g_KeyDownStates[byte] &= ~(1 << bit);
-      Internal::g_KeyReleaseStates[byte] |= 1 << bit;
-    }
-  }
-  else if (event.type == SDL_MOUSEBUTTONDOWN || event.type == SDL_MOUSEBUTTONUP)
-  {
-    bool  state = event.type == SDL_MOUSEBUTTONDOWN;
-    
-    if (state)
-    {
-      Internal::g_MouseDownStates |= 1 << event.button.button;
-      Internal::g_MousePressStates |= 1 << event.button.button;
-    }
-    else
-    {
-      Internal::g_MouseDownStates &= ~(1 << event.button.button);
-      Internal::g_MouseReleaseStates |= 1 << event.button.button;
-    }
-  }
-  else if (event.type == SDL_TEXTINPUT)
-  {
-    // disregard non-ASCII input.
-    u8  c = event.text.text[0];
-    if (c & 0x80)
-    {
-      return;
-    }
-    
-    usize byte  = c / 8;
-    usize bit   = c % 8;
-    Internal::g_TextInputStates[byte] |= 1 << bit;
-  }
-}
 
-void  PrepareInput()
+// keycodes outside of the character range are SDL_SCANCODE_TO_KEYCODE()
+// values, which are moved down to follow it.
+usize KeyIndex(SDL_Keycode key)
 {
-  memset(Internal::g_KeyPressStates, 0, sizeof(Internal::g_KeyPressStates));
-  memset(Internal::g_KeyReleaseStates, 0, sizeof(Internal::g_KeyReleaseStates));
-  
-  Internal::g_MousePressStates = 0;
-  Internal::g_MouseReleaseStates = 0;
-  
-  memset(Internal::g_TextInputStates, 0, sizeof(Internal::g_TextInputStates));
+  usize index = key & 1 << 30 ? (key & ~(1 << 30)) + 128 : key;
+  return (index);
 }
 
-bool  KeyDown(SDL_Keycode key)
+// false for events that do not go through the ring.
+bool  ToInputEvent(const SDL_Event& event, u64 time, OUT InputEvent& input)
 {
-  if (key & 1 << 30)
+  input = InputEvent{};
+  input.m_Time = time;
+  switch (event.type)
   {
-    key &= ~(1 << 30);
-    key += 128;
+  case SDL_KEYDOWN:
+  case SDL_KEYUP:
+    input.m_Type = event.type == SDL_KEYDOWN ? INPUT_KEY_DOWN : INPUT_KEY_UP;
+    input.m_Code = event.key.keysym.sym;
+    input.m_Mod = event.key.keysym.mod;
+    return (!event.key.repeat);
+  case SDL_MOUSEBUTTONDOWN:
+  case SDL_MOUSEBUTTONUP:
+    input.m_Type = event.type == SDL_MOUSEBUTTONDOWN ? INPUT_MOUSE_DOWN : INPUT_MOUSE_UP;
+    input.m_Code = event.button.button;
+    input.m_X = event.button.x;
+    input.m_Y = event.button.y;
+    return (true);
+  case SDL_MOUSEMOTION:
+    input.m_Type = INPUT_MOUSE_MOTION;
+    input.m_X = event.motion.x;
+    input.m_Y = event.motion.y;
+    input.m_DeltaX = event.motion.xrel;
+    input.m_DeltaY = event.motion.yrel;
+    return (true);
+  case SDL_MOUSEWHEEL:
+    input.m_Type = INPUT_MOUSE_WHEEL;
+    input.m_DeltaX = event.wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -event.wheel.x : event.wheel.x;
+    input.m_DeltaY = event.wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -event.wheel.y : event.wheel.y;
+    return (true);
+  default:
+    return (false);
   }
-  usize byte  = key / 8;
-  usize bit   = key % 8;
-  bool  down  = Internal::g_KeyDownStates[byte] & 1 << bit;
-  return (down);
 }
 
-bool  KeyPressed(SDL_Keycode key)
+// a lock-free single producer / single consumer ring. SDL runs its event
+// watchers one at a time, so the watcher is the only producer while
+// WatchInput() is in effect, and HandleInput otherwise. events that do not
+// fit are dropped.
+bool  PushInputEntry(const InputEvent& input, usize limit)
 {
-  if (key & 1 << 30)
+  u32 head  = SDL_AtomicGet(&g_InputEventsHead);
+  if (head - (u32)SDL_AtomicGet(&g_InputEventsTail) >= limit)
   {
-    key &= ~(1 << 30);
-    key += 128;
+    return (false);
   }
-  usize byte  = key / 8;
-  usize bit   = key % 8;
-  bool  down  = Internal::g_KeyPressStates[byte] & 1 << bit;
-  return (down);
+  
+  g_InputEvents[head % MAX_INPUT_EVENTS] = input;
+  SDL_MemoryBarrierRelease();
+  SDL_AtomicSet(&g_InputEventsHead, head + 1);
+  return (true);
 }
 
-bool  KeyReleased(SDL_Keycode key)
+void  MergeInputEvent(IN_OUT InputEvent& pending, const InputEvent& input)
 {
-  if (key & 1 << 30)
+  if (pending.m_Type != input.m_Type)
   {
-    key &= ~(1 << 30);
-    key += 128;
+    pending = input;
+    return;
   }
-  usize byte  = key / 8;
-  usize bit   = key % 8;
-  bool  down  = Internal::g_KeyReleaseStates[byte] & 1 << bit;
-  return (down);
+  
+  pending.m_Time = input.m_Time;
+  pending.m_X = input.m_X;
+  pending.m_Y = input.m_Y;
+  pending.m_DeltaX += input.m_DeltaX;
+  pending.m_DeltaY += input.m_DeltaY;
 }
 
-SDL_Point MousePos(const SDL_Window* window)
+void  LoseInputRelease(usize bit)
 {
-  if (SDL_GetMouseFocus() != window)
+  SDL_atomic_t& word  = g_InputLostReleases[bit / 32];
+  i32           mask  = (i32)((u32)1 << bit % 32);
+  for (i32 old = SDL_AtomicGet(&word); !SDL_AtomicCAS(&word, old, old | mask); old = SDL_AtomicGet(&word))
   {
-    return (SDL_Point{});
   }
-  
-  i32 x {};
-  i32 y {};
-  SDL_GetMouseState(&x, &y);
-  
-  return (SDL_Point{x, y});
-}
-
-bool  MouseDown(i32 button)
-{
-  bool  down  = !!(Internal::g_MouseDownStates & 1 << button);
-  return (down);
-}
-
-bool  MousePressed(i32 button)
-{
-  bool  down  = !!(Internal::g_MousePressStates & 1 << button);
-  return (down);
 }
 
-bool  MouseReleased(i32 button)
+// motion and wheel only fill the ring up to three quarters, past that they
+// add up in a pending event each until there is room again. keys and
+// buttons get the rest. once one of those does not fit, releases are kept
+// aside and presses dropped until the consumer has caught up, so that the
+// releases still come after everything in the ring and nothing stays held.
+void  PushInputEvent(const InputEvent& input)
 {
-  bool  down  = !!(Internal::g_MouseReleaseStates & 1 << button);
-  return (down);
-}
-
+  if (input.m_Type == INPUT_MOUSE_MOTION)
+  {
+    MergeInputEvent(g_InputPendingMotion, input);
+  }
+  else if (input.m_Type == INPUT_MOUSE_WHEEL)
+  {
+    MergeInputEvent(g_InputPendingWheel, input);
+  }
+  
+  usize limit = MAX_INPUT_EVENTS - MAX_INPUT_EVENTS / 4;
+  if (g_InputPendingMotion.m_Type == INPUT_MOUSE_MOTION && PushInputEntry(g_InputPendingMotion, limit))
+  {
+    g_InputPendingMotion = InputEvent{};
+  }
+  
+  if (g_InputPendingWheel.m_Type == INPUT_MOUSE_WHEEL && PushInputEntry(g_InputPendingWheel, limit))
+  {
+    g_InputPendingWheel = InputEvent{};
+  }
+  
+  if (input.m_Type == INPUT_MOUSE_MOTION || input.m_Type == INPUT_MOUSE_WHEEL)
+  {
+    return;
+  }
+  
+  if (!SDL_AtomicGet(&g_InputLost) && PushInputEntry(input, MAX_INPUT_EVENTS))
+  {
+    return;
+  }
+  
+  if (input.m_Type == INPUT_KEY_UP && KeyIndex(input.m_Code) < MAX_KEYS)
+  {
+    LoseInputRelease(KeyIndex(input.m_Code));
+  }
+  else if (input.m_Type == INPUT_MOUSE_UP && input.m_Code >= 0 && input.m_Code < 8)
+  {
+    LoseInputRelease(MAX_KEYS + input.m_Code);
+  }
+  
+  SDL_AtomicSet(&g_InputLost, 1);
+}
+
+i32 WatchInputEvent(void* userdata, SDL_Event* event)
+{
+  (void)userdata;
+  
+  InputEvent  input {};
+  if (ToInputEvent(*event, SDL_GetPerformanceCounter(), input))
+  {
+    PushInputEvent(input);
+  }
+  
+  return (0);
+}
+
+// the down / pressed / released state is kept up to date from the events,
+// which are recorded for the frame as well.
+void  ApplyInputEvent(const InputEvent& input)
+{
+  if (input.m_Type == INPUT_KEY_DOWN || input.m_Type == INPUT_KEY_UP)
+  {
+    usize key   = KeyIndex(input.m_Code);
+    usize byte  = key / 8;
+    usize bit   = key % 8;
+    g_Input.m_Mod = input.m_Mod;
+    
+    if (input.m_Type == INPUT_KEY_DOWN)
+    {
+      g_Input.m_KeyDown[byte] |= 1 << bit;
+      g_Input.m_KeyPress[byte] |= 1 << bit;
+    }
+    else
+    {
+      g_Input.m_KeyDown[byte] &= ~(1 << bit);
+      g_Input.m_KeyRelease[byte] |= 1 << bit;
+    }
+  }
+  else if (input.m_Type == INPUT_MOUSE_DOWN || input.m_Type == INPUT_MOUSE_UP)
+  {
+    g_Input.m_MouseX = input.m_X;
+    g_Input.m_MouseY = input.m_Y;
+    
+    if (input.m_Type == INPUT_MOUSE_DOWN)
+    {
+      g_Input.m_MouseDown |= 1 << input.m_Code;
+      g_Input.m_MousePress |= 1 << input.m_Code;
+    }
+    else
+    {
+      g_Input.m_MouseDown &= ~(1 << input.m_Code);
+      g_Input.m_MouseRelease |= 1 << input.m_Code;
+    }
+  }
+  else if (input.m_Type == INPUT_MOUSE_MOTION)
+  {
+    g_Input.m_MouseX = input.m_X;
+    g_Input.m_MouseY = input.m_Y;
+    g_Input.m_MouseDeltaX += input.m_DeltaX;
+    g_Input.m_MouseDeltaY += input.m_DeltaY;
+  }
+  else if (input.m_Type == INPUT_MOUSE_WHEEL)
+  {
+    g_Input.m_MouseWheel += input.m_DeltaY;
+  }
+  
+  // motion and wheel come in floods, so a run of them becomes one event.
+  usize       n     = g_Input.m_EventsLength;
+  InputEvent* last  = n ? &g_Input.m_Events[n - 1] : nullptr;
+  if (last && last->m_Type == input.m_Type && (input.m_Type == INPUT_MOUSE_MOTION || input.m_Type == INPUT_MOUSE_WHEEL))
+  {
+    last->m_Time = input.m_Time;
+    last->m_X = input.m_X;
+    last->m_Y = input.m_Y;
+    last->m_DeltaX += input.m_DeltaX;
+    last->m_DeltaY += input.m_DeltaY;
+  }
+  else if (n < MAX_FRAME_EVENTS)
+  {
+    g_Input.m_Events[g_Input.m_EventsLength++] = input;
+  }
+}
+
+void  DrainInputEvents()
+{
+  u32 head  = SDL_AtomicGet(&g_InputEventsHead);
+  SDL_MemoryBarrierAcquire();
+  for (u32 tail = SDL_AtomicGet(&g_InputEventsTail); tail != head; ++tail)
+  {
+    ApplyInputEvent(g_InputEvents[tail % MAX_INPUT_EVENTS]);
+    SDL_AtomicSet(&g_InputEventsTail, tail + 1);
+  }
+  
+  // releases that did not fit come last, without an event for the frame.
+  if (!SDL_AtomicSet(&g_InputLost, 0))
+  {
+    return;
+  }
+  
+  for (usize word = 0; word < MAX_KEYS / 32; ++word)
+  {
+    u32 lost  = SDL_AtomicSet(&g_InputLostReleases[word], 0);
+    for (usize bit = 0; bit < 32; ++bit)
+    {
+      if (lost & (u32)1 << bit)
+      {
+        usize key = word * 32 + bit;
+        g_Input.m_KeyDown[key / 8] &= ~(1 << key % 8);
+        g_Input.m_KeyRelease[key / 8] |= 1 << key % 8;
+      }
+    }
+  }
+  
+  u32 buttons = SDL_AtomicSet(&g_InputLostReleases[MAX_KEYS / 32], 0);
+  g_Input.m_MouseDown &= ~buttons;
+  g_Input.m_MouseRelease |= buttons;
+}
+
+}
+
+// keys, mouse buttons, motion and wheel go through the event ring, all that
+// the watcher put there is applied on the first event handled.
+void  HandleInput(const SDL_Event& event)
+{
+  InputEvent  input {};
+  if (!Internal::g_InputWatched && Internal::ToInputEvent(event, SDL_GetPerformanceCounter(), input))
+  {
+    Internal::PushInputEvent(input);
+  }
+  Internal::DrainInputEvents();
+  
+  if (event.type == SDL_MOUSEMOTION)
+  {
+    Internal::g_Input.m_MouseFocus = SDL_GetWindowFromID(event.motion.windowID);
+  }
+  else if (event.type == SDL_WINDOWEVENT)
+  {
+    if (event.window.event == SDL_WINDOWEVENT_ENTER)
+    {
+      Internal::g_Input.m_MouseFocus = SDL_GetWindowFromID(event.window.windowID);
+    }
+    else if (event.window.event == SDL_WINDOWEVENT_LEAVE)
+    {
+      Internal::g_Input.m_MouseFocus = nullptr;
+    }
+  }
+  else if (event.type == SDL_TEXTINPUT)
+  {
+    // events are kept whole so that codepoints never get split.
+    usize n = strlen(event.text.text);
+    if (Internal::g_Input.m_TextLength + n < MAX_TEXT_INPUT)
+    {
+      memcpy(&Internal::g_Input.m_Text[Internal::g_Input.m_TextLength], event.text.text, n + 1);
+      Internal::g_Input.m_TextLength += n;
+    }
+  }
+}
+
+void  PrepareInput()
+{
+  memset(Internal::g_Input.m_KeyPress, 0, sizeof(Internal::g_Input.m_KeyPress));
+  memset(Internal::g_Input.m_KeyRelease, 0, sizeof(Internal::g_Input.m_KeyRelease));
+  
+  Internal::g_Input.m_MousePress = 0;
+  Internal::g_Input.m_MouseRelease = 0;
+  
+  Internal::g_Input.m_Text[0] = 0;
+  Internal::g_Input.m_TextLength = 0;
+  
+  // widgets only read the snapshot, so the cursor holds still for a frame.
+  Internal::g_Input.m_MouseFocus = SDL_GetMouseFocus();
+  SDL_GetMouseState(&Internal::g_Input.m_MouseX, &Internal::g_Input.m_MouseY);
+  Internal::g_Input.m_MouseDeltaX = 0;
+  Internal::g_Input.m_MouseDeltaY = 0;
+  Internal::g_Input.m_MouseWheel = 0;
+  Internal::g_Input.m_Mod = SDL_GetModState();
+  Internal::g_Input.m_EventsLength = 0;
+}
+
+bool  KeyDown(SDL_Keycode key)
+{
+  usize index = Internal::KeyIndex(key);
+  usize byte  = index / 8;
+  usize bit   = index % 8;
+  bool  down  = Internal::t_Input->m_KeyDown[byte] & 1 << bit;
+  return (down);
+}
+
+bool  KeyPressed(SDL_Keycode key)
+{
+  usize index = Internal::KeyIndex(key);
+  usize byte  = index / 8;
+  usize bit   = index % 8;
+  bool  down  = Internal::t_Input->m_KeyPress[byte] & 1 << bit;
+  return (down);
+}
+
+bool  KeyReleased(SDL_Keycode key)
+{
+  usize index = Internal::KeyIndex(key);
+  usize byte  = index / 8;
+  usize bit   = index % 8;
+  bool  down  = Internal::t_Input->m_KeyRelease[byte] & 1 << bit;
+  return (down);
+}
+
+SDL_Point MousePos(const SDL_Window* window)
+{
+  if (Internal::t_Input->m_MouseFocus != window)
+  {
+    return (SDL_Point{});
+  }
+  
+  return (SDL_Point{Internal::t_Input->m_MouseX, Internal::t_Input->m_MouseY});
+}
+
+// relative motion accumulated over the events of this frame.
+SDL_Point MouseDelta()
+{
+  return (SDL_Point{Internal::t_Input->m_MouseDeltaX, Internal::t_Input->m_MouseDeltaY});
+}
+
+// vertical wheel steps of this frame, positive away from the user.
+i32 MouseWheel()
+{
+  return (Internal::t_Input->m_MouseWheel);
+}
+
+bool  MouseDown(i32 button)
+{
+  bool  down  = !!(Internal::t_Input->m_MouseDown & 1 << button);
+  return (down);
+}
+
+bool  MousePressed(i32 button)
+{
+  bool  down  = !!(Internal::t_Input->m_MousePress & 1 << button);
+  return (down);
+}
+
+bool  MouseReleased(i32 button)
+{
+  bool  down  = !!(Internal::t_Input->m_MouseRelease & 1 << button);
+  return (down);
+}
+
 bool  TextInput(char c)
 {
-  usize byte  = c / 8;
-  usize bit   = c % 8;
-  bool  down  = Internal::g_TextInputStates[byte] & 1 << bit;
+  bool  down  = c && memchr(Internal::t_Input->m_Text, c, Internal::t_Input->m_TextLength);
   return (down);
 }
 
+// UTF-8 text typed this frame, in the order it was typed.
+const char* TypedText()
+{
+  return (Internal::t_Input->m_Text);
+}
+
 bool  ShiftDown()
 {
-  SDL_Keymod  modState  = SDL_GetModState();
-  bool        down      = modState & KMOD_LSHIFT || modState & KMOD_RSHIFT;
+  u16   modState  = Internal::t_Input->m_Mod;
+  bool  down      = modState & KMOD_LSHIFT || modState & KMOD_RSHIFT;
   return (down);
 }
 
 bool  CtrlDown()
 {
-  SDL_Keymod  modState  = SDL_GetModState();
-  bool        down      = modState & KMOD_LCTRL || modState & KMOD_RCTRL;
+  u16   modState  = Internal::t_Input->m_Mod;
+  bool  down      = modState & KMOD_LCTRL || modState & KMOD_RCTRL;
   return (down);
 }
 
 bool  AltDown()
 {
-  SDL_Keymod  modState  = SDL_GetModState();
-  bool        down      = modState & KMOD_LALT || modState & KMOD_RALT;
+  u16   modState  = Internal::t_Input->m_Mod;
+  bool  down      = modState & KMOD_LALT || modState & KMOD_RALT;
   return (down);
 }
 
-//---------//
-// options //
-//---------//
+// this frame's input events in the order they happened.
+const InputEvent* InputEvents(OUT usize& n)
+{
+  n = Internal::t_Input->m_EventsLength;
+  return (Internal::t_Input->m_Events);
+}
 
-ErrorCode OptionRaw(OUT char data[], FILE* file, const char* key)
+// stamps input events when SDL queues them rather than when HandleInput()
+// gets to them, for timing within a frame. events must still be passed to
+// HandleInput() as usual.
+void  WatchInput()
+{
+  if (!Internal::g_InputWatched)
+  {
+    SDL_AddEventWatch(Internal::WatchInputEvent, nullptr);
+    Internal::g_InputWatched = true;
+  }
+}
+
+// call after handling all queued events, or some of them go through twice.
+void  UnwatchInput()
+{
+  if (Internal::g_InputWatched)
+  {
+    SDL_DelEventWatch(Internal::WatchInputEvent, nullptr);
+    Internal::g_InputWatched = false;
+    Internal::DrainInputEvents();
+  }
+}
+
+namespace Internal
+{
+
+// cuts the next name off a binding. a separator right at the start of a
+// name, or with nothing after it, is taken as the key of that name, so that
+// e.g. "Keypad +" and "Left Shift++" work.
+bool  NextBindingName(IN_OUT const char*& text, char separator, OUT char name[], usize capacity)
+{
+  while (isspace(*text))
+  {
+    ++text;
+  }
+  
+  const char* begin = text;
+  for (; *text; ++text)
+  {
+    const char* rest  = text + 1;
+    while (isspace(*rest))
+    {
+      ++rest;
+    }
+    
+    if (*text == separator && text != begin && *rest)
+    {
+      break;
+    }
+  }
+  
+  const char* end = text;
+  while (end > begin && isspace(end[-1]))
+  {
+    --end;
+  }
+  
+  text += *text == separator;
+  
+  usize n = end - begin < (isize)capacity - 1 ? end - begin : capacity - 1;
+  memcpy(name, begin, n);
+  name[n] = 0;
+  return (n > 0);
+}
+
+}
+
+// returns false if the map is full or a key is out of range.
+bool  ActionMap::Bind(u16 action, const SDL_Keycode keys[], usize n)
+{
+  if (m_ChordsLength >= m_ChordsCapacity || action >= MAX_ACTIONS || !n)
+  {
+    return (false);
+  }
+  
+  // keys within the same word share one mask.
+  ActionChord chord {};
+  chord.m_Action = action;
+  for (usize i = 0; i < n; ++i)
+  {
+    usize index = Internal::KeyIndex(keys[i]);
+    if (index >= MAX_KEYS)
+    {
+      return (false);
+    }
+    
+    u8    word  = index / 64;
+    usize pair  = 0;
+    while (pair < chord.m_Length && chord.m_Words[pair] != word)
+    {
+      ++pair;
+    }
+    
+    if (pair >= MAX_CHORD_KEYS)
+    {
+      return (false);
+    }
+    
+    chord.m_Words[pair] = word;
+    chord.m_Masks[pair] |= (u64)1 << index % 64;
+    chord.m_Length += pair == chord.m_Length;
+  }
+  
+  m_Chords[m_ChordsLength++] = chord;
+  return (true);
+}
+
+// reads bindings in the form "Left Ctrl+S, Return", i.e. chords of SDL key
+// names joined by '+', separated by ','. nothing is bound on an error.
+ErrorCode ActionMap::Bind(u16 action, FILE* file, const char* key)
+{
+  char      buffer[MAX_OPTION_VALUE]  = {0};
+  ErrorCode err = OptionRaw(buffer, file, key);
+  if (err)
+  {
+    return (err);
+  }
+  
+  usize       length  = m_ChordsLength;
+  const char* text    = buffer;
+  char        chord[MAX_OPTION_VALUE];
+  while (Internal::NextBindingName(text, ',', chord, sizeof(chord)))
+  {
+    SDL_Keycode keys[MAX_CHORD_KEYS];
+    usize       n     = 0;
+    const char* names = chord;
+    char        name[MAX_OPTION_VALUE];
+    while (Internal::NextBindingName(names, '+', name, sizeof(name)))
+    {
+      SDL_Keycode k = SDL_GetKeyFromName(name);
+      if (k == SDLK_UNKNOWN || n >= MAX_CHORD_KEYS)
+      {
+        m_ChordsLength = length;
+        return (INVALID_CONVERSION);
+      }
+      keys[n++] = k;
+    }
+    
+    if (!Bind(action, keys, n))
+    {
+      bool  full  = m_ChordsLength >= m_ChordsCapacity;
+      m_ChordsLength = length;
+      return (full ? OUT_OF_SPACE : INVALID_CONVERSION);
+    }
+  }
+  
+  return (OK);
+}
+
+void  ActionMap::Unbind(u16 action)
+{
+  for (usize i = 0; i < m_ChordsLength;)
+  {
+    if (m_Chords[i].m_Action == action)
+    {
+      m_Chords[i] = m_Chords[--m_ChordsLength];
+    }
+    else
+    {
+      ++i;
+    }
+  }
+}
+
+// a chord is down while all of its keys are, pressed on the frame its last
+// key goes down and released on the frame its first key goes up. a key
+// tapped within one frame counts for both.
+void  ActionMap::Update()
+{
+  // key bit i is bit i % 64 of word i / 64, whatever the host byte order.
+  u64 down[MAX_KEYS / 64]     = {0};
+  u64 pressed[MAX_KEYS / 64]  = {0};
+  u64 released[MAX_KEYS / 64] = {0};
+  for (usize byte = 0; byte < MAX_KEYS / 8; ++byte)
+  {
+    down[byte / 8] |= (u64)Internal::t_Input->m_KeyDown[byte] << byte % 8 * 8;
+    pressed[byte / 8] |= (u64)Internal::t_Input->m_KeyPress[byte] << byte % 8 * 8;
+    released[byte / 8] |= (u64)Internal::t_Input->m_KeyRelease[byte] << byte % 8 * 8;
+  }
+  
+  memset(m_Down, 0, sizeof(m_Down));
+  memset(m_Pressed, 0, sizeof(m_Pressed));
+  memset(m_Released, 0, sizeof(m_Released));
+  
+  for (usize i = 0; i < m_ChordsLength; ++i)
+  {
+    const ActionChord&  chord       = m_Chords[i];
+    bool                allDown     = true;
+    bool                allPressed  = true;
+    bool                allReleased = true;
+    bool                anyPressed  = false;
+    bool                anyReleased = false;
+    for (usize pair = 0; pair < chord.m_Length; ++pair)
+    {
+      u64 mask  = chord.m_Masks[pair];
+      u8  word  = chord.m_Words[pair];
+      allDown &= (down[word] & mask) == mask;
+      allPressed &= ((down[word] | pressed[word]) & mask) == mask;
+      allReleased &= ((down[word] | released[word]) & mask) == mask;
+      anyPressed |= (pressed[word] & mask) != 0;
+      anyReleased |= (released[word] & mask) != 0;
+    }
+    
+    u64 bit = (u64)1 << chord.m_Action % 64;
+    m_Down[chord.m_Action / 64] |= allDown ? bit : 0;
+    m_Pressed[chord.m_Action / 64] |= allPressed && anyPressed ? bit : 0;
+    m_Released[chord.m_Action / 64] |= allReleased && anyReleased ? bit : 0;
+  }
+}
+
+bool  ActionMap::Down(u16 action) const
+{
+  bool  down  = m_Down[action / 64] >> action % 64 & 1;
+  return (down);
+}
+
+bool  ActionMap::Pressed(u16 action) const
+{
+  bool  down  = m_Pressed[action / 64] >> action % 64 & 1;
+  return (down);
+}
+
+bool  ActionMap::Released(u16 action) const
+{
+  bool  down  = m_Released[action / 64] >> action % 64 & 1;
+  return (down);
+}
+
+ActionMap::ActionMap(ActionChord chords[], usize chordsCapacity)
+  : m_Chords(chords),
+  m_ChordsCapacity(chordsCapacity)
+{
+}
+
+//---------//
+// options //
+//---------//
+
+ErrorCode OptionRaw(OUT char data[], FILE* file, const char* key)
+{
+  fseek(file, 0, SEEK_SET);
+  
+  for (usize line = 0; !feof(file) && !ferror(file); ++line)
+  {
+    i32 c {};
+    while (c = fgetc(file), c != EOF && isspace(c))
+    {
+    }
+    
+    if (c == '#')
+    {
+      while (c = fgetc(file), c != EOF && c != '\n')
+      {
+      }
+    }
+    
+    if (c == '\n' || feof(file))
+    {
+      continue;
+    }
+    
+    fseek(file, -1, SEEK_CUR);
+    char  keyBuffer[MAX_OPTION_KEY] = {0};
+    if (fscanf(file, OPTION_SCAN, keyBuffer, data) != 2)
+    {
+      return (INVALID_FORMAT);
+    }
+    
+    if (!strcmp(data, "NONE"))
+    {
+      data[0] = 0;
+    }
+    
+    if (!strcmp(keyBuffer, key))
+    {
+      return (OK);
+    }
+  }
+  
+  return (NOT_FOUND);
+}
+
+ErrorCode OptionKeycode(OUT SDL_Keycode& data, FILE* file, const char* key)
+{
+  char      buffer[MAX_OPTION_VALUE]  = {0};
+  ErrorCode err = OptionRaw(buffer, file, key);
+  if (err)
+  {
+    return (err);
+  }
+  
+  data = SDL_GetKeyFromName(buffer);
+  if (data == SDLK_UNKNOWN)
+  {
+    return (INVALID_CONVERSION);
+  }
+  
+  return (OK);
+}
+
+ErrorCode OptionFloat(OUT f32& data, FILE* file, const char* key)
+{
+  char      buffer[MAX_OPTION_VALUE]  = {0};
+  ErrorCode err = OptionRaw(buffer, file, key);
+  if (err)
+  {
+    return (err);
+  }
+  
+  errno = 0;
+  data = strtof(buffer, nullptr);
+  if (errno)
+  {
+    return (INVALID_CONVERSION);
+  }
+  
+  return (OK);
+}
+
+ErrorCode OptionInt(OUT i64& data, FILE* file, const char* key)
+{
+  char      buffer[MAX_OPTION_VALUE]  = {0};
+  ErrorCode err = OptionRaw(buffer, file, key);
+  if (err)
+  {
+    return (err);
+  }
+  
+  errno = 0;
+  data = (i64)strtoll(buffer, nullptr, 0);
+  if (errno)
+  {
+    return (INVALID_CONVERSION);
+  }
+  
+  return (OK);
+}
+
+ErrorCode OptionBool(OUT bool& data, FILE* file, const char* key)
+{
+  char      buffer[MAX_OPTION_VALUE]  = {0};
+  ErrorCode err = OptionRaw(buffer, file, key);
+  if (err)
+  {
+    return (err);
+  }
+  
+  if (!strcmp(buffer, "true"))
+  {
+    data = true;
+    return (OK);
+  }
+  else if (!strcmp(buffer, "false"))
+  {
+    data = false;
+    return (OK);
+  }
+  else
+  {
+    return (INVALID_CONVERSION);
+  }
+}
+
+// values are written by SaveAtlas as "page x y w h".
+ErrorCode OptionAtlasRect(OUT AtlasRect& data, FILE* file, const char* key)
+{
+  char      buffer[MAX_OPTION_VALUE]  = {0};
+  ErrorCode err = OptionRaw(buffer, file, key);
+  if (err)
+  {
+    return (err);
+  }
+  
+  AtlasRect rect  {};
+  if (sscanf(buffer, "%d %d %d %d %d", &rect.m_Page, &rect.m_X, &rect.m_Y, &rect.m_W, &rect.m_H) != 5)
+  {
+    return (INVALID_CONVERSION);
+  }
+  
+  data = rect;
+  return (OK);
+}
+
+//-----------//
+// rendering //
+//-----------//
+
+namespace Internal
+{
+
+bool  RectsOverlap(const SDL_Rect& a, const SDL_Rect& b)
+{
+  bool  overlap = a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+  return (overlap);
+}
+
+bool  ClipRect(IN_OUT SDL_Rect& r, const SDL_Rect& clip)
+{
+  i32 minX  = r.x > clip.x ? r.x : clip.x;
+  i32 minY  = r.y > clip.y ? r.y : clip.y;
+  i32 maxX  = r.x + r.w < clip.x + clip.w ? r.x + r.w : clip.x + clip.w;
+  i32 maxY  = r.y + r.h < clip.y + clip.h ? r.y + r.h : clip.y + clip.h;
+  
+  r = SDL_Rect{minX, minY, maxX - minX, maxY - minY};
+  return (maxX > minX && maxY > minY);
+}
+
+// innermost pushed clip, pushes past MAX_CLIP_DEPTH reuse the deepest one.
+const SDL_Rect& TopClip(const DrawList& list)
+{
+  usize depth = list.m_ClipDepth < MAX_CLIP_DEPTH ? list.m_ClipDepth : MAX_CLIP_DEPTH;
+  return (list.m_ClipStack[depth - 1]);
+}
+
+void  RecordDrawCmd(DrawList& list, DrawType type, i32 x, i32 y, i32 w, i32 h, const char* text, usize length, Color color)
+{
+  if (list.m_CmdsLength >= list.m_CmdsCapacity || list.m_Clip == NO_CLIP_STORAGE)
+  {
+    return;
+  }
+  
+  // work that would be clipped away entirely is dropped at record time.
+  SDL_Rect  r {x, y, w, h};
+  if (list.m_Clip && !ClipRect(r, list.m_Clips[list.m_Clip - 1]))
+  {
+    return;
+  }
+  
+  DrawCmd&  cmd = list.m_Cmds[list.m_CmdsLength++];
+  cmd.m_Text    = text;
+  cmd.m_X       = x;
+  cmd.m_Y       = y;
+  cmd.m_W       = w;
+  cmd.m_H       = h;
+  cmd.m_Length  = length;
+  cmd.m_Next    = 0;
+  cmd.m_Clip    = list.m_Clip;
+  cmd.m_Type    = type;
+  cmd.m_Color   = color;
+}
+
+// falls back to one m_RenderText per character without a run callback.
+void  RenderTextRun(i32 x, i32 y, i32 advance, i32 h, const char* text, usize length, Color color)
+{
+  if (g_Conf.m_RenderTextRun)
+  {
+    g_Conf.m_RenderTextRun(x, y, advance, h, text, length, color);
+    return;
+  }
+  
+  // one cell per codepoint, drawn with all of its bytes.
+  for (usize i = 0, cell = 0; i < length; ++cell)
+  {
+    char  render[5] = {text[i++], 0};
+    for (usize n = 1; n < 4 && i < length && (text[i] & 0xc0) == 0x80; ++n)
+    {
+      render[n] = text[i++];
+    }
+    
+    g_Conf.m_RenderText(x + cell * advance, y, advance, h, render, color);
+  }
+}
+
+void  SubmitDrawGroups(const DrawList& list, usize nGroups, IN_OUT u16& clip)
+{
+  SDL_Rect  rects[256];
+  usize     nRects  = 0;
+  
+  for (usize i = 0; i < nGroups; ++i)
+  {
+    const DrawGroup&  group = g_DrawGroups[i];
+    if (group.m_Clip != clip)
+    {
+      clip = group.m_Clip;
+      Platform::SetClip(clip ? &list.m_Clips[clip - 1] : nullptr);
+    }
+    
+    // every command in a group shares its state, so rects go out together.
+    for (u32 j = group.m_First;; j = list.m_Cmds[j].m_Next)
+    {
+      const DrawCmd&  cmd = list.m_Cmds[j];
+      if (group.m_Type == DRAW_RECT)
+      {
+        if (nRects >= sizeof(rects) / sizeof(rects[0]))
+        {
+          Platform::RenderRects(rects, nRects, group.m_Color);
+          nRects = 0;
+        }
+        rects[nRects++] = SDL_Rect{cmd.m_X, cmd.m_Y, cmd.m_W, cmd.m_H};
+      }
+      else if (group.m_Type == DRAW_TEXT)
+      {
+        Platform::RenderText(cmd.m_X, cmd.m_Y, cmd.m_W, cmd.m_H, cmd.m_Text, group.m_Color);
+      }
+      else
+      {
+        i32 advance = cmd.m_W / cmd.m_Length;
+        Platform::RenderTextRun(cmd.m_X, cmd.m_Y, advance, cmd.m_H, cmd.m_Text, cmd.m_Length, group.m_Color);
+      }
+      
+      if (j == group.m_Last)
+      {
+        break;
+      }
+    }
+    
+    if (nRects)
+    {
+      Platform::RenderRects(rects, nRects, group.m_Color);
+      nRects = 0;
+    }
+  }
+}
+
+}
+
+DrawList::DrawList(DrawCmd cmds[], usize cmdsCapacity, SDL_Rect clips[], usize clipsCapacity)
+  : m_Cmds(cmds),
+  m_CmdsCapacity(cmdsCapacity),
+  m_Clips(clips),
+  m_ClipsCapacity(clipsCapacity)
+{
+}
+
+void  DrawList::Rect(i32 x, i32 y, i32 w, i32 h, Color color)
+{
+  if (!Visible(x, y, w, h))
+  {
+    return;
+  }
+  
+  x += m_OffsetX;
+  y += m_OffsetY;
+  
+  if (!m_Cmds)
+  {
+    g_Conf.m_RenderRect(x, y, w, h, color);
+    return;
+  }
+  
+  Internal::RecordDrawCmd(*this, Internal::DRAW_RECT, x, y, w, h, nullptr, 0, color);
+}
+
+void  DrawList::Text(i32 x, i32 y, i32 w, i32 h, const char* text, Color color)
+{
+  if (!Visible(x, y, w, h))
+  {
+    return;
+  }
+  
+  x += m_OffsetX;
+  y += m_OffsetY;
+  
+  if (!m_Cmds)
+  {
+    g_Conf.m_RenderText(x, y, w, h, text, color);
+    return;
+  }
+  
+  Internal::RecordDrawCmd(*this, Internal::DRAW_TEXT, x, y, w, h, text, 0, color);
+}
+
+void  DrawList::TextRun(i32 x, i32 y, i32 advance, i32 h, const char* text, usize length, Color color)
+{
+  if (!length || !Visible(x, y, advance * length, h))
+  {
+    return;
+  }
+  
+  x += m_OffsetX;
+  y += m_OffsetY;
+  
+  if (!m_Cmds)
+  {
+    Internal::RenderTextRun(x, y, advance, h, text, length, color);
+    return;
+  }
+  
+  // width covers the whole run so that clipping and grouping see all of it.
+  Internal::RecordDrawCmd(*this, Internal::DRAW_TEXT_RUN, x, y, advance * length, h, text, length, color);
+}
+
+void  DrawList::SetClip(const SDL_Rect* clip)
+{
+  SDL_Rect  translated  {};
+  if (clip)
+  {
+    translated = SDL_Rect{clip->x + m_OffsetX, clip->y + m_OffsetY, clip->w, clip->h};
+    clip = &translated;
+  }
+  
+  if (!m_Cmds)
+  {
+    if (g_Conf.m_SetClip)
+    {
+      g_Conf.m_SetClip(clip);
+    }
+    return;
+  }
+  
+  if (!clip)
+  {
+    m_Clip = 0;
+    return;
+  }
+  
+  // without room for the clip, nothing drawn under it can be recorded.
+  if (m_ClipsLength >= m_ClipsCapacity)
+  {
+    m_Clip = Internal::NO_CLIP_STORAGE;
+    return;
+  }
+  
+  m_Clips[m_ClipsLength++] = *clip;
+  m_Clip = m_ClipsLength;
+}
+
+void  DrawList::PushClip(const SDL_Rect& clip)
+{
+  SDL_Rect  r = clip;
+  if (m_ClipDepth && !Internal::ClipRect(r, Internal::TopClip(*this)))
+  {
+    r = SDL_Rect{r.x, r.y, 0, 0};
+  }
+  
+  if (m_ClipDepth < MAX_CLIP_DEPTH)
+  {
+    m_ClipStack[m_ClipDepth] = r;
+  }
+  ++m_ClipDepth;
+  
+  SetClip(&Internal::TopClip(*this));
+}
+
+void  DrawList::PopClip()
+{
+  if (!m_ClipDepth)
+  {
+    return;
+  }
+  
+  --m_ClipDepth;
+  SetClip(m_ClipDepth ? &Internal::TopClip(*this) : nullptr);
+}
+
+// whether anything of the rect survives the pushed clips, so that callers
+// can skip the work of drawing it.
+bool  DrawList::Visible(i32 x, i32 y, i32 w, i32 h) const
+{
+  if (!m_ClipDepth)
+  {
+    return (true);
+  }
+  
+  SDL_Rect  r {x, y, w, h};
+  return (Internal::ClipRect(r, Internal::TopClip(*this)));
+}
+
+// submission reorders commands into groups of equal state (type, color and
+// clip), merging each group into as few platform calls as possible. a
+// command only joins an earlier group if nothing in between overlaps it.
+void  DrawList::Submit()
+{
+  u16   clip    = 0;
+  usize nGroups = 0;
+  
+  for (usize i = 0; i < m_CmdsLength; ++i)
+  {
+    DrawCmd&  cmd   = m_Cmds[i];
+    SDL_Rect  r     {cmd.m_X, cmd.m_Y, cmd.m_W, cmd.m_H};
+    if (cmd.m_Clip)
+    {
+      Internal::ClipRect(r, m_Clips[cmd.m_Clip - 1]);
+    }
+    
+    usize group = nGroups;
+    for (usize j = nGroups, n = 0; j > 0 && n < BATCH_LOOKBACK; --j, ++n)
+    {
+      const Internal::DrawGroup&  other = Internal::g_DrawGroups[j - 1];
+      if (other.m_Type == cmd.m_Type && other.m_Color == cmd.m_Color && other.m_Clip == cmd.m_Clip)
+      {
+        group = j - 1;
+        break;
+      }
+      
+      if (Internal::RectsOverlap(other.m_Bounds, r))
+      {
+        break;
+      }
+    }
+    
+    if (group == nGroups)
+    {
+      if (nGroups >= MAX_DRAW_GROUPS)
+      {
+        Internal::SubmitDrawGroups(*this, nGroups, clip);
+        nGroups = 0;
+        group = 0;
+      }
+      
+      Internal::g_DrawGroups[group].m_Bounds  = r;
+      Internal::g_DrawGroups[group].m_First   = i;
+      Internal::g_DrawGroups[group].m_Last    = i;
+      Internal::g_DrawGroups[group].m_Clip    = cmd.m_Clip;
+      Internal::g_DrawGroups[group].m_Type    = cmd.m_Type;
+      Internal::g_DrawGroups[group].m_Color   = cmd.m_Color;
+      ++nGroups;
+      continue;
+    }
+    
+    Internal::DrawGroup&  g       = Internal::g_DrawGroups[group];
+    SDL_Rect&             bounds  = g.m_Bounds;
+    i32                   minX    = r.x < bounds.x ? r.x : bounds.x;
+    i32                   minY    = r.y < bounds.y ? r.y : bounds.y;
+    i32                   maxX    = r.x + r.w > bounds.x + bounds.w ? r.x + r.w : bounds.x + bounds.w;
+    i32                   maxY    = r.y + r.h > bounds.y + bounds.h ? r.y + r.h : bounds.y + bounds.h;
+    bounds = SDL_Rect{minX, minY, maxX - minX, maxY - minY};
+    
+    m_Cmds[g.m_Last].m_Next = i;
+    g.m_Last = i;
+  }
+  
+  Internal::SubmitDrawGroups(*this, nGroups, clip);
+  if (clip)
+  {
+    Platform::SetClip(nullptr);
+  }
+}
+
+void  DrawList::Replay() const
+{
+  u16 clip  = 0;
+  for (usize i = 0; i < m_CmdsLength; ++i)
+  {
+    const DrawCmd&  cmd = m_Cmds[i];
+    if (cmd.m_Clip != clip && g_Conf.m_SetClip)
+    {
+      clip = cmd.m_Clip;
+      g_Conf.m_SetClip(clip ? &m_Clips[clip - 1] : nullptr);
+    }
+    
+    if (cmd.m_Type == Internal::DRAW_RECT)
+    {
+      g_Conf.m_RenderRect(cmd.m_X, cmd.m_Y, cmd.m_W, cmd.m_H, cmd.m_Color);
+    }
+    else if (cmd.m_Type == Internal::DRAW_TEXT)
+    {
+      g_Conf.m_RenderText(cmd.m_X, cmd.m_Y, cmd.m_W, cmd.m_H, cmd.m_Text, cmd.m_Color);
+    }
+    else
+    {
+      i32 advance = cmd.m_W / cmd.m_Length;
+      Internal::RenderTextRun(cmd.m_X, cmd.m_Y, advance, cmd.m_H, cmd.m_Text, cmd.m_Length, cmd.m_Color);
+    }
+  }
+  
+  if (clip)
+  {
+    g_Conf.m_SetClip(nullptr);
+  }
+}
+
+void  DrawList::Clear()
+{
+  m_CmdsLength = 0;
+  m_ClipsLength = 0;
+  m_Clip = 0;
+  m_ClipDepth = 0;
+}
+
+// shelf packing in order of decreasing height, moving on to a new page
+// whenever one fills up. rects are reordered, m_ID tells them apart.
+u32 PackRects(IN_OUT AtlasRect rects[], usize n, i32 w, i32 h, i32 pad)
+{
+  qsort(rects, n, sizeof(AtlasRect), [](const void* lhs, const void* rhs) -> int
+  {
+    const AtlasRect*  a = (const AtlasRect*)lhs;
+    const AtlasRect*  b = (const AtlasRect*)rhs;
+    return (a->m_H != b->m_H ? b->m_H - a->m_H : b->m_W - a->m_W);
+  });
+  
+  i32 page    = 0;
+  i32 shelfX  = 0;
+  i32 shelfY  = 0;
+  i32 shelfH  = 0;
+  u32 nPages  = 0;
+  for (usize i = 0; i < n; ++i)
+  {
+    i32 rw  = rects[i].m_W + pad;
+    i32 rh  = rects[i].m_H + pad;
+    if (rw > w || rh > h)
+    {
+      rects[i].m_Page = -1;
+      continue;
+    }
+    
+    if (shelfX + rw > w)
+    {
+      shelfX = 0;
+      shelfY += shelfH;
+      shelfH = 0;
+    }
+    
+    if (shelfY + rh > h)
+    {
+      ++page;
+      shelfX = 0;
+      shelfY = 0;
+      shelfH = 0;
+    }
+    
+    rects[i].m_X = shelfX;
+    rects[i].m_Y = shelfY;
+    rects[i].m_Page = page;
+    nPages = page + 1;
+    
+    shelfX += rw;
+    shelfH = rh > shelfH ? rh : shelfH;
+  }
+  
+  return (nPages);
+}
+
+// rects[i] describes images[i] on return. pages are ARGB8888 surfaces, to
+// be turned into textures at runtime or written out by SaveAtlas. returns 0,
+// with no pages left allocated, if a page can't be created or drawn into.
+u32 BuildAtlas(SDL_Surface* const images[], OUT AtlasRect rects[], usize n, i32 w, i32 h, i32 pad, OUT SDL_Surface* pages[], u32 maxPages)
+{
+  for (usize i = 0; i < n; ++i)
+  {
+    rects[i] = AtlasRect{images[i]->w, images[i]->h, 0, 0, -1, (u32)i};
+  }
+  
+  u32 nPages  = PackRects(rects, n, w, h, pad);
+  nPages = nPages < maxPages ? nPages : maxPages;
+  
+  qsort(rects, n, sizeof(AtlasRect), [](const void* lhs, const void* rhs) -> int
+  {
+    const AtlasRect*  a = (const AtlasRect*)lhs;
+    const AtlasRect*  b = (const AtlasRect*)rhs;
+    return (a->m_ID < b->m_ID ? -1 : a->m_ID > b->m_ID);
+  });
+  
+  for (u32 i = 0; i < nPages; ++i)
+  {
+    pages[i] = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!pages[i])
+    {
+      for (u32 j = 0; j < i; ++j)
+      {
+        SDL_FreeSurface(pages[j]);
+        pages[j] = nullptr;
+      }
+      return (0);
+    }
+    
+    SDL_FillRect(pages[i], nullptr, 0);
+  }
+  
+  for (usize i = 0; i < n; ++i)
+  {
+    if (rects[i].m_Page < 0 || (u32)rects[i].m_Page >= nPages)
+    {
+      rects[i].m_Page = -1;
+      continue;
+    }
+    
+    // copy alpha as is rather than blending onto the empty page.
+    SDL_BlendMode mode  {};
+    SDL_GetSurfaceBlendMode(images[i], &mode);
+    SDL_SetSurfaceBlendMode(images[i], SDL_BLENDMODE_NONE);
+    
+    SDL_Rect  dst     {rects[i].m_X, rects[i].m_Y, rects[i].m_W, rects[i].m_H};
+    i32       failed  = SDL_BlitSurface(images[i], nullptr, pages[rects[i].m_Page], &dst);
+    SDL_SetSurfaceBlendMode(images[i], mode);
+    
+    if (failed)
+    {
+      for (u32 j = 0; j < nPages; ++j)
+      {
+        SDL_FreeSurface(pages[j]);
+        pages[j] = nullptr;
+      }
+      return (0);
+    }
+  }
+  
+  return (nPages);
+}
+
+// pages are written next to the descriptor as <path>.<page>.bmp, and the
+// descriptor itself is an options file mapping names[m_ID] to its rect.
+// names must not contain whitespace.
+ErrorCode SaveAtlas(const char* path, SDL_Surface* const pages[], u32 nPages, const char* const names[], const AtlasRect rects[], usize n)
+{
+  char  pagePath[FILENAME_MAX];
+  for (u32 i = 0; i < nPages; ++i)
+  {
+    snprintf(pagePath, sizeof(pagePath), "%s.%u.bmp", path, i);
+    if (SDL_SaveBMP(pages[i], pagePath))
+    {
+      return (WRITE_FAILED);
+    }
+  }
+  
+  FILE* file  = fopen(path, "wb");
+  if (!file)
+  {
+    return (WRITE_FAILED);
+  }
+  
+  fprintf(file, "pages = %u\n", nPages);
+  for (usize i = 0; i < n; ++i)
+  {
+    if (rects[i].m_Page < 0)
+    {
+      continue;
+    }
+    
+    fprintf(
+      file,
+      "%s = %d %d %d %d %d\n",
+      names[rects[i].m_ID],
+      rects[i].m_Page,
+      rects[i].m_X,
+      rects[i].m_Y,
+      rects[i].m_W,
+      rects[i].m_H
+    );
+  }
+  
+  bool  failed  = ferror(file);
+  fclose(file);
+  return (failed ? WRITE_FAILED : OK);
+}
+
+//----//
+// ui //
+//----//
+
+namespace Internal
+{
+
+u64 HashMix(u64 hash, u64 value)
+{
+  hash ^= value;
+  hash *= 0x100000001b3;
+  return (hash);
+}
+
+const FormattedText*  FormattedIn(const BumpAllocator* arena, const char* text)
+{
+  if (!arena || text < (const char*)arena->m_Buffer + sizeof(FormattedText) || text >= (const char*)arena->m_Buffer + arena->m_Capacity)
+  {
+    return (nullptr);
+  }
+  
+  const FormattedText*  header  = (const FormattedText*)text - 1;
+  return (header->m_Text == text ? header : nullptr);
+}
+
+const FormattedText*  Formatted(const char* text)
+{
+  const FormattedText*  header  = FormattedIn(t_TextArena, text);
+  return (header ? header : FormattedIn(g_Conf.m_TextArena, text));
+}
+
+// formatted text was hashed once when it was formatted.
+u64 TextHash(const char* text)
+{
+  const FormattedText*  header  = Formatted(text);
+  return (header ? header->m_Hash : HashString(text));
+}
+
+// formatted text is known by its format, so a widget keeps its state while
+// the numbers in its text change.
+u64 TextID(const char* text)
+{
+  const FormattedText*  header  = Formatted(text);
+  return (header ? header->m_ID : HashString(text));
+}
+
+// the text stays valid until the arena is reset. without an arena, or once
+// it is full, the format itself is shown.
+const char* FormatText(const char* format, va_list args)
+{
+  BumpAllocator*  arena = t_TextArena ? t_TextArena : g_Conf.m_TextArena;
+  if (!arena)
+  {
+    return (format);
+  }
+  
+  // the header is placed for its fields, whatever the buffer's alignment.
+  usize pad     = -(uintptr_t)&arena->m_Buffer[arena->m_Length] % alignof(FormattedText);
+  usize header  = pad + sizeof(FormattedText);
+  if (Align(arena->m_Length + header, MEMORY_ALIGN) > arena->m_Capacity)
+  {
+    return (format);
+  }
+  
+  // formatted straight into the arena, and only allocated if it fit once
+  // Alloc() has aligned it.
+  char* text  = (char*)&arena->m_Buffer[arena->m_Length + header];
+  usize room  = arena->m_Capacity - arena->m_Length - header;
+  i32   n     = vsnprintf(text, room, format, args);
+  if (n < 0 || Align(arena->m_Length + header + n + 1, MEMORY_ALIGN) > arena->m_Capacity)
+  {
+    memset(text, 0, room);
+    return (format);
+  }
+  
+  u8* memory  = (u8*)arena->Alloc(header + n + 1);
+  if (!memory)
+  {
+    return (format);
+  }
+  
+  FormattedText*  formatted = (FormattedText*)(memory + pad);
+  formatted->m_Hash = HashString(text);
+  formatted->m_ID = HashString(format);
+  formatted->m_Text = text;
+  
+  return (text);
+}
+
+// the mouse as the panel sees it, nowhere when outside the panel's clip.
+SDL_Point PanelMouse(const UIPanel& panel)
+{
+  SDL_Point m     = MousePos(panel.m_Window);
+  SDL_Rect  clip  = panel.m_Clip;
+  if (clip.w > 0 && clip.h > 0 && (m.x < clip.x || m.y < clip.y || m.x >= clip.x + clip.w || m.y >= clip.y + clip.h))
+  {
+    return (SDL_Point{INT32_MIN / 2, INT32_MIN / 2});
+  }
+  
+  return (m);
+}
+
+// in flow layout, a widget wholly outside the clip is hidden and dropped.
+// the cursor still steps over it, so later widgets and the content extent
+// stay where they would be.
+bool  Culled(IN_OUT UIPanel& panel, i32 w, i32 h)
+{
+  const SDL_Rect& clip  = panel.m_Clip;
+  if (clip.w <= 0 || clip.h <= 0 || (panel.m_Layout && panel.m_Layout->m_StackLength))
+  {
+    return (false);
+  }
+  
+  if (panel.m_X < clip.x + clip.w && panel.m_Y < clip.y + clip.h && panel.m_X + w > clip.x && panel.m_Y + h > clip.y)
+  {
+    return (false);
+  }
+  
+  if (panel.m_Horizontal)
+  {
+    panel.m_X += w;
+  }
+  else
+  {
+    panel.m_Y += h;
+  }
+  
+  return (true);
+}
+
+void  MirrorElem(IN_OUT UIPanel& panel, usize i)
+{
+  if (!panel.m_Arrays.m_Type)
+  {
+    return;
+  }
+  
+  panel.m_Arrays.m_X[i]     = panel.m_Elems[i].m_Any.m_X;
+  panel.m_Arrays.m_Y[i]     = panel.m_Elems[i].m_Any.m_Y;
+  panel.m_Arrays.m_W[i]     = panel.m_Elems[i].m_Any.m_W;
+  panel.m_Arrays.m_H[i]     = panel.m_Elems[i].m_Any.m_H;
+  panel.m_Arrays.m_Type[i]  = panel.m_Elems[i].m_Any.m_Type;
+  panel.m_Arrays.m_Flags[i] = panel.m_Elems[i].m_Any.m_Flags;
+}
+
+// moves the elements into fresh storage from the panel's arena. what they
+// occupied before stays allocated until the arena is reset.
+bool  ReserveElems(IN_OUT UIPanel& panel, usize capacity, bool arrays)
+{
+  BumpAllocator*  arena = panel.m_Arena;
+  UIElem*         elems = (UIElem*)arena->Alloc(capacity * sizeof(UIElem));
+  if (!elems)
+  {
+    return (false);
+  }
+  
+  UIElemArrays  a {};
+  if (arrays)
+  {
+    a.m_X = (i32*)arena->Alloc(capacity * sizeof(i32));
+    a.m_Y = (i32*)arena->Alloc(capacity * sizeof(i32));
+    a.m_W = (i32*)arena->Alloc(capacity * sizeof(i32));
+    a.m_H = (i32*)arena->Alloc(capacity * sizeof(i32));
+    a.m_Type = (u8*)arena->Alloc(capacity * sizeof(u8));
+    a.m_Flags = (u16*)arena->Alloc(capacity * sizeof(u16));
+    if (!a.m_X || !a.m_Y || !a.m_W || !a.m_H || !a.m_Type || !a.m_Flags)
+    {
+      return (false);
+    }
+  }
+  
+  usize n = panel.m_ElemsLength;
+  if (n)
+  {
+    memcpy(elems, panel.m_Elems, n * sizeof(UIElem));
+  }
+  
+  if (n && arrays)
+  {
+    memcpy(a.m_X, panel.m_Arrays.m_X, n * sizeof(i32));
+    memcpy(a.m_Y, panel.m_Arrays.m_Y, n * sizeof(i32));
+    memcpy(a.m_W, panel.m_Arrays.m_W, n * sizeof(i32));
+    memcpy(a.m_H, panel.m_Arrays.m_H, n * sizeof(i32));
+    memcpy(a.m_Type, panel.m_Arrays.m_Type, n * sizeof(u8));
+    memcpy(a.m_Flags, panel.m_Arrays.m_Flags, n * sizeof(u16));
+  }
+  
+  panel.m_Elems = elems;
+  panel.m_Arrays = a;
+  panel.m_ElemsCapacity = capacity;
+  return (true);
+}
+
+// doubling keeps the total allocated under twice what ends up used.
+bool  GrowElems(IN_OUT UIPanel& panel)
+{
+  if (!panel.m_Arena)
+  {
+    return (false);
+  }
+  
+  usize capacity  = 2 * panel.m_ElemsCapacity;
+  capacity = capacity < MIN_ARENA_ELEMS ? MIN_ARENA_ELEMS : capacity;
+  return (ReserveElems(panel, capacity, panel.m_Arrays.m_Type));
+}
+
+#if !defined(__AVX2__) && defined(__SSE2__)
+// SSE2 lacks 32-bit min / max, so select through a comparison mask.
+__m128i MinI32(__m128i a, __m128i b)
+{
+  __m128i gt  = _mm_cmpgt_epi32(a, b);
+  return (_mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a)));
+}
+
+__m128i MaxI32(__m128i a, __m128i b)
+{
+  __m128i gt  = _mm_cmpgt_epi32(a, b);
+  return (_mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b)));
+}
+#endif
+
+// min / max reduction over the element arrays, vectors then the tail.
+void  ArrayBounds(const UIElemArrays& a, usize n, IN_OUT i32& minX, IN_OUT i32& minY, IN_OUT i32& maxX, IN_OUT i32& maxY)
+{
+  usize i = 0;
+#if defined(__AVX2__)
+  __m256i vMinX = _mm256_set1_epi32(INT32_MAX);
+  __m256i vMinY = _mm256_set1_epi32(INT32_MAX);
+  __m256i vMaxX = _mm256_set1_epi32(INT32_MIN);
+  __m256i vMaxY = _mm256_set1_epi32(INT32_MIN);
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256i x = _mm256_loadu_si256((const __m256i*)&a.m_X[i]);
+    __m256i y = _mm256_loadu_si256((const __m256i*)&a.m_Y[i]);
+    __m256i w = _mm256_loadu_si256((const __m256i*)&a.m_W[i]);
+    __m256i h = _mm256_loadu_si256((const __m256i*)&a.m_H[i]);
+    vMinX = _mm256_min_epi32(vMinX, x);
+    vMinY = _mm256_min_epi32(vMinY, y);
+    vMaxX = _mm256_max_epi32(vMaxX, _mm256_add_epi32(x, w));
+    vMaxY = _mm256_max_epi32(vMaxY, _mm256_add_epi32(y, h));
+  }
+  
+  i32 lanes[4][8];
+  _mm256_storeu_si256((__m256i*)lanes[0], vMinX);
+  _mm256_storeu_si256((__m256i*)lanes[1], vMinY);
+  _mm256_storeu_si256((__m256i*)lanes[2], vMaxX);
+  _mm256_storeu_si256((__m256i*)lanes[3], vMaxY);
+  for (usize j = 0; j < 8; ++j)
+  {
+    minX = lanes[0][j] < minX ? lanes[0][j] : minX;
+    minY = lanes[1][j] < minY ? lanes[1][j] : minY;
+    maxX = lanes[2][j] > maxX ? lanes[2][j] : maxX;
+    maxY = lanes[3][j] > maxY ? lanes[3][j] : maxY;
+  }
+#elif defined(__SSE2__)
+  __m128i vMinX = _mm_set1_epi32(INT32_MAX);
+  __m128i vMinY = _mm_set1_epi32(INT32_MAX);
+  __m128i vMaxX = _mm_set1_epi32(INT32_MIN);
+  __m128i vMaxY = _mm_set1_epi32(INT32_MIN);
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128i x = _mm_loadu_si128((const __m128i*)&a.m_X[i]);
+    __m128i y = _mm_loadu_si128((const __m128i*)&a.m_Y[i]);
+    __m128i w = _mm_loadu_si128((const __m128i*)&a.m_W[i]);
+    __m128i h = _mm_loadu_si128((const __m128i*)&a.m_H[i]);
+    vMinX = MinI32(vMinX, x);
+    vMinY = MinI32(vMinY, y);
+    vMaxX = MaxI32(vMaxX, _mm_add_epi32(x, w));
+    vMaxY = MaxI32(vMaxY, _mm_add_epi32(y, h));
+  }
+  
+  i32 lanes[4][4];
+  _mm_storeu_si128((__m128i*)lanes[0], vMinX);
+  _mm_storeu_si128((__m128i*)lanes[1], vMinY);
+  _mm_storeu_si128((__m128i*)lanes[2], vMaxX);
+  _mm_storeu_si128((__m128i*)lanes[3], vMaxY);
+  for (usize j = 0; j < 4; ++j)
+  {
+    minX = lanes[0][j] < minX ? lanes[0][j] : minX;
+    minY = lanes[1][j] < minY ? lanes[1][j] : minY;
+    maxX = lanes[2][j] > maxX ? lanes[2][j] : maxX;
+    maxY = lanes[3][j] > maxY ? lanes[3][j] : maxY;
+  }
+#endif
+  
+  for (; i < n; ++i)
+  {
+    minX = a.m_X[i] < minX ? a.m_X[i] : minX;
+    minY = a.m_Y[i] < minY ? a.m_Y[i] : minY;
+    maxX = a.m_X[i] + a.m_W[i] > maxX ? a.m_X[i] + a.m_W[i] : maxX;
+    maxY = a.m_Y[i] + a.m_H[i] > maxY ? a.m_Y[i] + a.m_H[i] : maxY;
+  }
+}
+
+// index of the first element under the mouse, or m_ElemsLength if none.
+usize HoveredElem(const UIPanel& panel, SDL_Point m)
+{
+  usize               i = 0;
+  usize               n = panel.m_ElemsLength;
+  const UIElemArrays& a = panel.m_Arrays;
+  if (a.m_Type)
+  {
+#if defined(__AVX2__)
+    __m256i mx  = _mm256_set1_epi32(m.x);
+    __m256i my  = _mm256_set1_epi32(m.y);
+    for (; i + 8 <= n; i += 8)
+    {
+      __m256i x   = _mm256_loadu_si256((const __m256i*)&a.m_X[i]);
+      __m256i y   = _mm256_loadu_si256((const __m256i*)&a.m_Y[i]);
+      __m256i x1  = _mm256_add_epi32(x, _mm256_loadu_si256((const __m256i*)&a.m_W[i]));
+      __m256i y1  = _mm256_add_epi32(y, _mm256_loadu_si256((const __m256i*)&a.m_H[i]));
+      __m256i inX = _mm256_andnot_si256(_mm256_cmpgt_epi32(x, mx), _mm256_cmpgt_epi32(x1, mx));
+      __m256i inY = _mm256_andnot_si256(_mm256_cmpgt_epi32(y, my), _mm256_cmpgt_epi32(y1, my));
+      u32     hit = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(inX, inY)));
+      if (hit)
+      {
+        return (i + __builtin_ctz(hit));
+      }
+    }
+#elif defined(__SSE2__)
+    __m128i mx  = _mm_set1_epi32(m.x);
+    __m128i my  = _mm_set1_epi32(m.y);
+    for (; i + 4 <= n; i += 4)
+    {
+      __m128i x   = _mm_loadu_si128((const __m128i*)&a.m_X[i]);
+      __m128i y   = _mm_loadu_si128((const __m128i*)&a.m_Y[i]);
+      __m128i x1  = _mm_add_epi32(x, _mm_loadu_si128((const __m128i*)&a.m_W[i]));
+      __m128i y1  = _mm_add_epi32(y, _mm_loadu_si128((const __m128i*)&a.m_H[i]));
+      __m128i inX = _mm_andnot_si128(_mm_cmpgt_epi32(x, mx), _mm_cmpgt_epi32(x1, mx));
+      __m128i inY = _mm_andnot_si128(_mm_cmpgt_epi32(y, my), _mm_cmpgt_epi32(y1, my));
+      u32     hit = _mm_movemask_ps(_mm_castsi128_ps(_mm_and_si128(inX, inY)));
+      if (hit)
+      {
+        return (i + __builtin_ctz(hit));
+      }
+    }
+#endif
+  }
+  
+  for (; i < n; ++i)
+  {
+    const UIElem& elem  = panel.m_Elems[i];
+    if (m.x >= elem.m_Any.m_X
+      && m.y >= elem.m_Any.m_Y
+      && m.x < elem.m_Any.m_X + elem.m_Any.m_W
+      && m.y < elem.m_Any.m_Y + elem.m_Any.m_H)
+    {
+      return (i);
+    }
+  }
+  
+  return (n);
+}
+
+// next index at or after i holding the given type, or n if none.
+usize NextOfType(const u8 types[], usize i, usize n, u8 type)
+{
+#if defined(__SSE2__)
+  __m128i vType = _mm_set1_epi8(type);
+  for (; i + 16 <= n; i += 16)
+  {
+    __m128i t   = _mm_loadu_si128((const __m128i*)&types[i]);
+    u32     hit = _mm_movemask_epi8(_mm_cmpeq_epi8(t, vType));
+    if (hit)
+    {
+      return (i + __builtin_ctz(hit));
+    }
+  }
+#endif
+  
+  for (; i < n; ++i)
+  {
+    if (types[i] == type)
+    {
+      return (i);
+    }
+  }
+  
+  return (n);
+}
+
+SDL_Rect  PanelBounds(const UIPanel& panel)
+{
+  i32 minX  = INT32_MAX;
+  i32 minY  = INT32_MAX;
+  i32 maxX  = INT32_MIN;
+  i32 maxY  = INT32_MIN;
+  if (panel.m_Arrays.m_Type)
+  {
+    ArrayBounds(panel.m_Arrays, panel.m_ElemsLength, minX, minY, maxX, maxY);
+  }
+  
+  for (usize i = 0; !panel.m_Arrays.m_Type && i < panel.m_ElemsLength; ++i)
+  {
+    i32 x = panel.m_Elems[i].m_Any.m_X;
+    i32 y = panel.m_Elems[i].m_Any.m_Y;
+    i32 w = panel.m_Elems[i].m_Any.m_W;
+    i32 h = panel.m_Elems[i].m_Any.m_H;
+    
+    minX  = x < minX ? x : minX;
+    minY  = y < minY ? y : minY;
+    maxX  = x + w > maxX ? x + w : maxX;
+    maxY  = y + h > maxY ? y + h : maxY;
+  }
+  
+  i32 pad = g_Conf.m_UIPad;
+  return (SDL_Rect{minX - pad, minY - pad, maxX - minX + 2 * pad, maxY - minY + 2 * pad});
+}
+
+// rows of a list that get drawn, the visible ones plus some overscan.
+void  ListRange(const UIElem& elem, OUT usize& first, OUT usize& last)
+{
+  i32   rowH    = elem.m_List.m_RowH;
+  i32   scroll  = elem.m_List.m_State->m_Scroll;
+  usize count   = elem.m_List.m_Count;
+  
+  first = scroll / rowH;
+  last = (scroll + elem.m_List.m_H + rowH - 1) / rowH;
+  first = first > LIST_OVERSCAN ? first - LIST_OVERSCAN : 0;
+  last = last + LIST_OVERSCAN < count ? last + LIST_OVERSCAN : count;
+}
+
+i32 ListThumb(i32 h, i64 content)
+{
+  i64 thumb = content ? (i64)h * h / content : h;
+  thumb = thumb < g_Conf.m_UIScrollBar ? g_Conf.m_UIScrollBar : thumb;
+  return (thumb < h ? thumb : h);
+}
+
+// covers everything UIPanel::Render reads, with hover reduced to which
+// element is under the mouse so that mouse motion alone is free.
+u64 HashPanel(const UIPanel& panel)
+{
+  u64 hash  = 0xcbf29ce484222325;
+  hash = HashMix(hash, g_Conf.m_UIPad);
+  hash = HashMix(hash, g_Conf.m_UITextFieldBar);
+  hash = HashMix(hash, g_Conf.m_UIScrollBar);
+  hash = HashMix(hash, (u64)(u32)panel.m_Clip.x << 32 | (u32)panel.m_Clip.y);
+  hash = HashMix(hash, (u64)(u32)panel.m_Clip.w << 32 | (u32)panel.m_Clip.h);
+  
+  SDL_Point m       = PanelMouse(panel);
+  usize     hovered = panel.m_ElemsLength;
+  for (usize i = 0; i < panel.m_ElemsLength; ++i)
+  {
+    const UIElem& elem  = panel.m_Elems[i];
+    hash = HashMix(hash, elem.m_Any.m_Type);
+    hash = HashMix(hash, elem.m_Any.m_Flags);
+    hash = HashMix(hash, (u64)(u32)elem.m_Any.m_X << 32 | (u32)elem.m_Any.m_Y);
+    hash = HashMix(hash, (u64)(u32)elem.m_Any.m_W << 32 | (u32)elem.m_Any.m_H);
+    
+    bool  inside  = m.x >= elem.m_Any.m_X
+      && m.y >= elem.m_Any.m_Y
+      && m.x < elem.m_Any.m_X + elem.m_Any.m_W
+      && m.y < elem.m_Any.m_Y + elem.m_Any.m_H;
+    
+    if (inside && hovered == panel.m_ElemsLength)
+    {
+      hovered = i;
+    }
+    
+    if (elem.m_Any.m_Type == LABEL)
+    {
+      hash = HashMix(hash, TextHash(elem.m_Label.m_Text));
+      continue;
+    }
+    
+    if (elem.m_Any.m_Type == SLIDER)
+    {
+      u32 value {};
+      memcpy(&value, &elem.m_Slider.m_Value, sizeof(value));
+      hash = HashMix(hash, value);
+      hash = HashMix(hash, TextHash(elem.m_Slider.m_Text));
+    }
+    else if (elem.m_Any.m_Type == TEXT_FIELD)
+    {
+      const TFData& data  = *elem.m_TextField.m_TFData;
+      hash = HashMix(hash, elem.m_TextField.m_NDraw);
+      hash = HashMix(hash, TextHash(elem.m_TextField.m_Text));
+      hash = HashMix(hash, HashString(data.m_Buffer));
+      hash = HashMix(hash, (u64)data.m_Cursor << 32 | data.m_First);
+      hash = HashMix(hash, data.m_Selected);
+    }
+    else if (elem.m_Any.m_Type == TEXT_EDITOR)
+    {
+      const TextModel&  model = *elem.m_TextEditor.m_Model;
+      hash = HashMix(hash, (u64)elem.m_TextEditor.m_Cols << 32 | elem.m_TextEditor.m_Rows);
+      hash = HashMix(hash, TextHash(elem.m_TextEditor.m_Text));
+      hash = HashMix(hash, model.m_Cursor);
+      hash = HashMix(hash, (u64)model.m_FirstLine << 32 ^ model.m_FirstColumn);
+      hash = HashMix(hash, model.m_Selected);
+      
+      // only the text in view matters.
+      usize last  = model.m_FirstLine + elem.m_TextEditor.m_Rows;
+      last = last < model.Lines() ? last : model.Lines();
+      for (usize line = model.m_FirstLine; line < last; ++line)
+      {
+        usize start   = model.LineStart(line);
+        usize length  = model.LineLength(line);
+        for (usize col = model.m_FirstColumn; col < length && col < model.m_FirstColumn + elem.m_TextEditor.m_Cols; ++col)
+        {
+          hash = HashMix(hash, (u8)model.At(start + col));
+        }
+        hash = HashMix(hash, '\n');
+      }
+    }
+    else if (elem.m_Any.m_Type == LIST)
+    {
+      const ListState&  state = *elem.m_List.m_State;
+      hash = HashMix(hash, (u64)elem.m_List.m_Count << 32 | (u32)elem.m_List.m_RowH);
+      hash = HashMix(hash, (u64)(u32)state.m_Scroll << 32 | (u32)state.m_Selected);
+      hash = HashMix(hash, state.m_HasSelection);
+      
+      usize first {};
+      usize last  {};
+      ListRange(elem, first, last);
+      for (usize row = first; row < last; ++row)
+      {
+        hash = HashMix(hash, TextHash(elem.m_List.m_Row(row, elem.m_List.m_Userdata)));
+      }
+      
+      // the row under the mouse is highlighted, on the same terms as in
+      // RenderList, with the row count standing for none.
+      i64   content   = (i64)elem.m_List.m_Count * elem.m_List.m_RowH;
+      i32   bar       = content > elem.m_Any.m_H ? g_Conf.m_UIScrollBar : 0;
+      usize mouseRow  = elem.m_List.m_Count;
+      if (hovered == i && m.x < elem.m_Any.m_X + elem.m_Any.m_W - bar)
+      {
+        mouseRow = (m.y - elem.m_Any.m_Y + state.m_Scroll) / elem.m_List.m_RowH;
+      }
+      hash = HashMix(hash, mouseRow);
+    }
+    else
+    {
+      hash = HashMix(hash, TextHash(elem.m_Button.m_Text));
+    }
+  }
+  
+  hash = HashMix(hash, hovered);
+  hash = HashMix(hash, hovered != panel.m_ElemsLength && MouseDown(SDL_BUTTON_LEFT));
+  
+  return (hash);
+}
+
+constexpr u32 NO_NODE = UINT32_MAX;
+constexpr u32 NO_ELEM = UINT32_MAX;
+
+i32 ClampSize(i32 size, i32 min, i32 max)
+{
+  size = size < min ? min : size;
+  size = max && size > max ? max : size;
+  return (size);
+}
+
+i32 AlignSpan(i32 start, i32 span, i32 size, u8 align)
+{
+  if (align == ALIGN_CENTER)
+  {
+    return (start + (span - size) / 2);
+  }
+  
+  if (align == ALIGN_END)
+  {
+    return (start + span - size);
+  }
+  
+  return (start);
+}
+
+SDL_Rect  AlignRect(i32 w, i32 h, const SDL_Rect& cell, u8 align)
+{
+  if (align == ALIGN_FILL)
+  {
+    return (cell);
+  }
+  
+  return (SDL_Rect{AlignSpan(cell.x, cell.w, w, align), AlignSpan(cell.y, cell.h, h, align), w, h});
+}
+
+// backward-shift deletion, so that probing never needs tombstones.
+void  RemoveLayoutNode(IN_OUT Layout& layout, usize hole)
+{
+  usize mask  = layout.m_NodesCapacity - 1;
+  for (usize i = (hole + 1) & mask; layout.m_Nodes[i].m_ID; i = (i + 1) & mask)
+  {
+    usize home  = layout.m_Nodes[i].m_ID & mask;
+    if (((i - home) & mask) >= ((i - hole) & mask))
+    {
+      layout.m_Nodes[hole] = layout.m_Nodes[i];
+      hole = i;
+    }
+  }
+  
+  layout.m_Nodes[hole] = LayoutNode{};
+  --layout.m_NodesLength;
+}
+
+// finds or creates the node and links it under the innermost open
+// container. returns NO_NODE when full or on a repeated ID.
+u32 VisitLayoutNode(IN_OUT Layout& layout, u64 id, u8 type, const LayoutStyle& style)
+{
+  id = id ? id : 1;
+  usize mask  = layout.m_NodesCapacity - 1;
+  usize slot  = id & mask;
+  while (layout.m_Nodes[slot].m_ID && layout.m_Nodes[slot].m_ID != id)
+  {
+    slot = (slot + 1) & mask;
+  }
+  
+  LayoutNode& node  = layout.m_Nodes[slot];
+  if (!node.m_ID)
+  {
+    if (4 * (layout.m_NodesLength + 1) > 3 * layout.m_NodesCapacity)
+    {
+      return (NO_NODE);
+    }
+    
+    node.m_ID = id;
+    ++layout.m_NodesLength;
+  }
+  else if (node.m_Frame == layout.m_Frame)
+  {
+    return (NO_NODE);
+  }
+  
+  node.m_Frame = layout.m_Frame;
+  node.m_Style = style;
+  node.m_Type = type;
+  node.m_Parent = NO_NODE;
+  node.m_FirstChild = NO_NODE;
+  node.m_LastChild = NO_NODE;
+  node.m_Next = NO_NODE;
+  node.m_Count = 0;
+  node.m_Elem = NO_ELEM;
+  
+  u32 index = slot;
+  if (layout.m_StackLength)
+  {
+    u32         parentIndex = layout.m_Stack[layout.m_StackLength - 1];
+    LayoutNode& parent      = layout.m_Nodes[parentIndex];
+    node.m_Parent = parentIndex;
+    if (parent.m_LastChild == NO_NODE)
+    {
+      parent.m_FirstChild = index;
+    }
+    else
+    {
+      layout.m_Nodes[parent.m_LastChild].m_Next = index;
+    }
+    parent.m_LastChild = index;
+    ++parent.m_Count;
+  }
+  
+  return (index);
+}
+
+// widgets inside a layout reuse the rect cached for them. until their node
+// has been solved once they are placed nowhere, so that nothing hit-tests
+// against a guessed rect; the solve moves the element into place.
+SDL_Rect  PlaceElem(IN_OUT UIPanel& panel, i32 w, i32 h)
+{
+  Layout* layout  = panel.m_Layout;
+  if (!layout || !layout->m_StackLength || layout->m_Stack[layout->m_StackLength - 1] == NO_NODE)
+  {
+    SDL_Rect  r {panel.m_X, panel.m_Y, w, h};
+    if (panel.m_Horizontal)
+    {
+      panel.m_X += w;
+    }
+    else
+    {
+      panel.m_Y += h;
+    }
+    return (r);
+  }
+  
+  LayoutStyle style   = layout->m_NextStyle;
+  layout->m_NextStyle = LayoutStyle{};
+  
+  // widgets are keyed by position, kept apart from user container IDs.
+  LayoutNode& parent  = layout->m_Nodes[layout->m_Stack[layout->m_StackLength - 1]];
+  u32         index   = VisitLayoutNode(*layout, HashMix(parent.m_ID, ~(u64)parent.m_Count), LAYOUT_LEAF, style);
+  if (index == NO_NODE)
+  {
+    return (SDL_Rect{panel.m_X, panel.m_Y, w, h});
+  }
+  
+  LayoutNode& node  = layout->m_Nodes[index];
+  node.m_PrefW = ClampSize(w, style.m_MinW, style.m_MaxW);
+  node.m_PrefH = ClampSize(h, style.m_MinH, style.m_MaxH);
+  node.m_Elem = panel.m_ElemsLength;
+  node.m_Inputs = HashMix(HashMix(LAYOUT_LEAF, (u64)(u32)node.m_PrefW << 32 | (u32)node.m_PrefH), style.m_Align);
+  
+  if (!node.m_Solved)
+  {
+    return (SDL_Rect{INT32_MIN / 2, INT32_MIN / 2, node.m_PrefW, node.m_PrefH});
+  }
+  
+  return (node.m_Rect);
+}
+
+// preferred size and input hash of a container, from its children.
+void  MeasureLayoutNode(IN_OUT Layout& layout, u32 index)
+{
+  LayoutNode&         node  = layout.m_Nodes[index];
+  const LayoutStyle&  style = node.m_Style;
+  
+  u64 inputs  = HashMix(node.m_Type, (u64)(u32)style.m_MinW << 32 | (u32)style.m_MinH);
+  inputs = HashMix(inputs, (u64)(u32)style.m_MaxW << 32 | (u32)style.m_MaxH);
+  inputs = HashMix(inputs, (u64)(u32)style.m_Gap << 32 | (u32)style.m_Pad);
+  inputs = HashMix(inputs, (u64)style.m_Columns << 8 | style.m_Align);
+  inputs = HashMix(inputs, node.m_Count);
+  
+  usize columns = style.m_Columns ? style.m_Columns : 1;
+  columns = columns > MAX_GRID_COLUMNS ? MAX_GRID_COLUMNS : columns;
+  
+  i32   colW[MAX_GRID_COLUMNS]  = {};
+  i32   w     = 0;
+  i32   h     = 0;
+  i32   rowH  = 0;
+  usize n     = 0;
+  for (u32 c = node.m_FirstChild; c != NO_NODE; c = layout.m_Nodes[c].m_Next, ++n)
+  {
+    const LayoutNode& child = layout.m_Nodes[c];
+    inputs = HashMix(inputs, child.m_Inputs);
+    
+    if (node.m_Type == LAYOUT_ROW)
+    {
+      w += child.m_PrefW + (n ? style.m_Gap : 0);
+      h = child.m_PrefH > h ? child.m_PrefH : h;
+    }
+    else if (node.m_Type == LAYOUT_COLUMN)
+    {
+      w = child.m_PrefW > w ? child.m_PrefW : w;
+      h += child.m_PrefH + (n ? style.m_Gap : 0);
+    }
+    else
+    {
+      usize col = n % columns;
+      colW[col] = child.m_PrefW > colW[col] ? child.m_PrefW : colW[col];
+      rowH = child.m_PrefH > rowH ? child.m_PrefH : rowH;
+      if (col == columns - 1 || child.m_Next == NO_NODE)
+      {
+        h += rowH + (n >= columns ? style.m_Gap : 0);
+        rowH = 0;
+      }
+    }
+  }
+  
+  if (node.m_Type == LAYOUT_GRID)
+  {
+    for (usize i = 0; i < columns && i < n; ++i)
+    {
+      w += colW[i] + (i ? style.m_Gap : 0);
+    }
+  }
+  
+  node.m_PrefW = ClampSize(w + 2 * style.m_Pad, style.m_MinW, style.m_MaxW);
+  node.m_PrefH = ClampSize(h + 2 * style.m_Pad, style.m_MinH, style.m_MaxH);
+  node.m_Inputs = inputs;
+}
+
+// places a subtree into the given cell, skipping it if nothing changed.
+void  SolveLayoutNode(IN_OUT UIPanel& panel, IN_OUT Layout& layout, u32 index, const SDL_Rect& cell, u8 align)
+{
+  LayoutNode& node  = layout.m_Nodes[index];
+  if (node.m_Solved == node.m_Inputs
+    && node.m_CellAlign == align
+    && node.m_Cell.x == cell.x
+    && node.m_Cell.y == cell.y
+    && node.m_Cell.w == cell.w
+    && node.m_Cell.h == cell.h)
+  {
+    return;
+  }
+  
+  node.m_Solved = node.m_Inputs;
+  node.m_Cell = cell;
+  node.m_CellAlign = align;
+  node.m_Rect = AlignRect(node.m_PrefW, node.m_PrefH, cell, align);
+  
+  if (node.m_Type == LAYOUT_LEAF)
+  {
+    if (node.m_Elem != NO_ELEM && node.m_Elem < panel.m_ElemsLength)
+    {
+      UIElem& elem  = panel.m_Elems[node.m_Elem];
+      elem.m_Any.m_X = node.m_Rect.x;
+      elem.m_Any.m_Y = node.m_Rect.y;
+      elem.m_Any.m_W = node.m_Rect.w;
+      elem.m_Any.m_H = node.m_Rect.h;
+      MirrorElem(panel, node.m_Elem);
+    }
+    return;
+  }
+  
+  const LayoutStyle&  style   = node.m_Style;
+  SDL_Rect            inner   =
+  {
+    node.m_Rect.x + style.m_Pad,
+    node.m_Rect.y + style.m_Pad,
+    node.m_Rect.w - 2 * style.m_Pad,
+    node.m_Rect.h - 2 * style.m_Pad
+  };
+  
+  if (node.m_Type == LAYOUT_ROW || node.m_Type == LAYOUT_COLUMN)
+  {
+    bool  row = node.m_Type == LAYOUT_ROW;
+    i32   pos = row ? inner.x : inner.y;
+    for (u32 c = node.m_FirstChild; c != NO_NODE; c = layout.m_Nodes[c].m_Next)
+    {
+      const LayoutNode& child = layout.m_Nodes[c];
+      SDL_Rect          r     = row
+        ? SDL_Rect{pos, inner.y, child.m_PrefW, inner.h}
+        : SDL_Rect{inner.x, pos, inner.w, child.m_PrefH};
+      u8                a     = child.m_Type == LAYOUT_LEAF && child.m_Style.m_Align ? child.m_Style.m_Align : style.m_Align;
+      pos += (row ? child.m_PrefW : child.m_PrefH) + style.m_Gap;
+      SolveLayoutNode(panel, layout, c, r, a);
+    }
+    return;
+  }
+  
+  usize columns = style.m_Columns ? style.m_Columns : 1;
+  columns = columns > MAX_GRID_COLUMNS ? MAX_GRID_COLUMNS : columns;
+  
+  i32   colW[MAX_GRID_COLUMNS]  = {};
+  usize n = 0;
+  for (u32 c = node.m_FirstChild; c != NO_NODE; c = layout.m_Nodes[c].m_Next, ++n)
+  {
+    i32 w = layout.m_Nodes[c].m_PrefW;
+    colW[n % columns] = w > colW[n % columns] ? w : colW[n % columns];
+  }
+  
+  // one row at a time, measuring its height before placing it.
+  i32 y   = inner.y;
+  u32 row = node.m_FirstChild;
+  while (row != NO_NODE)
+  {
+    i32 rowH  = 0;
+    u32 c     = row;
+    for (usize i = 0; i < columns && c != NO_NODE; ++i, c = layout.m_Nodes[c].m_Next)
+    {
+      rowH = layout.m_Nodes[c].m_PrefH > rowH ? layout.m_Nodes[c].m_PrefH : rowH;
+    }
+    
+    i32 x = inner.x;
+    c = row;
+    for (usize i = 0; i < columns && c != NO_NODE; ++i)
+    {
+      const LayoutNode& child = layout.m_Nodes[c];
+      u8                a     = child.m_Type == LAYOUT_LEAF && child.m_Style.m_Align ? child.m_Style.m_Align : style.m_Align;
+      u32               next  = child.m_Next;
+      SolveLayoutNode(panel, layout, c, SDL_Rect{x, y, colW[i], rowH}, a);
+      x += colW[i] + style.m_Gap;
+      c = next;
+    }
+    
+    y += rowH + style.m_Gap;
+    row = c;
+  }
+}
+
+void  RemoveWidgetState(IN_OUT WidgetStore& store, usize hole)
+{
+  usize mask  = store.m_StatesCapacity - 1;
+  for (usize i = (hole + 1) & mask; store.m_States[i].m_ID; i = (i + 1) & mask)
+  {
+    usize home  = store.m_States[i].m_ID & mask;
+    if (((i - home) & mask) >= ((i - hole) & mask))
+    {
+      store.m_States[hole] = store.m_States[i];
+      hole = i;
+    }
+  }
+  
+  store.m_States[hole] = WidgetState{};
+  --store.m_StatesLength;
+}
+
+WidgetState*  VisitWidget(const UIPanel& panel, const char* text)
+{
+  if (!panel.m_Store)
+  {
+    return (nullptr);
+  }
+  
+  return (panel.m_Store->Get(panel.m_Store->ID(text)));
+}
+
+// measurements are kept per widget, so only changed text, or a changed or
+// forgotten font, gets measured.
+void  MeasureWidget(WidgetState* state, TTF_Font* font, const char* text, OUT i32& w, OUT i32& h)
+{
+  if (!state)
+  {
+    TextSize(font, text, w, h);
+    return;
+  }
+  
+  u64 hash  = HashMix(HashMix(TextHash(text), (uintptr_t)font), SDL_AtomicGet(&g_FontGeneration));
+  if (state->m_TextHash != hash || !state->m_TextH)
+  {
+    TextSize(font, text, state->m_TextW, state->m_TextH);
+    state->m_TextHash = hash;
+  }
+  
+  w = state->m_TextW;
+  h = state->m_TextH;
+}
+
+// with a widget state, a release only counts if the press started on the
+// widget too. without one, any release over it does.
+bool  ReleasedOver(WidgetState* state, const SDL_Point& m, const SDL_Rect& r)
+{
+  bool  inside  = m.x >= r.x && m.y >= r.y && m.x < r.x + r.w && m.y < r.y + r.h;
+  if (!state)
+  {
+    return (inside && MouseReleased(SDL_BUTTON_LEFT));
+  }
+  
+  if (inside && MousePressed(SDL_BUTTON_LEFT))
+  {
+    state->m_Pressed = true;
+  }
+  
+  bool  released  = state->m_Pressed && inside && MouseReleased(SDL_BUTTON_LEFT);
+  if (!MouseDown(SDL_BUTTON_LEFT))
+  {
+    state->m_Pressed = false;
+  }
+  
+  return (released);
+}
+
+// moves the gap to a logical offset, carrying the line index along.
+void  MoveTextGap(IN_OUT TextModel& model, usize pos)
+{
+  if (pos < model.m_GapStart)
+  {
+    usize n = model.m_GapStart - pos;
+    memmove(&model.m_Buffer[model.m_GapEnd - n], &model.m_Buffer[pos], n);
+    model.m_GapStart -= n;
+    model.m_GapEnd -= n;
+  }
+  else if (pos > model.m_GapStart)
+  {
+    usize n = pos - model.m_GapStart;
+    memmove(&model.m_Buffer[model.m_GapStart], &model.m_Buffer[model.m_GapEnd], n);
+    model.m_GapStart += n;
+    model.m_GapEnd += n;
+  }
+  
+  // starts up to pos are absolute, the ones past it are from the end.
+  usize   length  = model.Length();
+  usize*  lines   = model.m_Lines;
+  usize   cap     = model.m_LinesCapacity;
+  while (model.m_LinesBefore && lines[model.m_LinesBefore - 1] > pos)
+  {
+    lines[cap - model.m_LinesAfter - 1] = length - lines[model.m_LinesBefore - 1];
+    ++model.m_LinesAfter;
+    --model.m_LinesBefore;
+  }
+  while (model.m_LinesAfter && length - lines[cap - model.m_LinesAfter] <= pos)
+  {
+    lines[model.m_LinesBefore] = length - lines[cap - model.m_LinesAfter];
+    ++model.m_LinesBefore;
+    --model.m_LinesAfter;
+  }
+}
+
+// codepoint boundaries around a byte offset, for UTF-8 cursor movement.
+u32 NextCodepoint(const char* text, u32 i, u32 length)
+{
+  i += i < length;
+  while (i < length && (text[i] & 0xc0) == 0x80)
+  {
+    ++i;
+  }
+  return (i);
+}
+
+u32 PrevCodepoint(const char* text, u32 i)
+{
+  i -= i > 0;
+  while (i > 0 && (text[i] & 0xc0) == 0x80)
+  {
+    --i;
+  }
+  return (i);
+}
+
+u32 CountCodepoints(const char* text, u32 begin, u32 end)
+{
+  u32 n = 0;
+  for (u32 i = begin; i < end; ++i)
+  {
+    n += (text[i] & 0xc0) != 0x80;
+  }
+  return (n);
+}
+
+const char* FreezeText(IN_OUT BumpAllocator& arena, const char* text)
+{
+  // formatted while building, so already in the frame's arena.
+  if (FormattedIn(&arena, text))
+  {
+    return (text);
+  }
+  
+  usize n     = strlen(text) + 1;
+  char* copy  = (char*)arena.Alloc(n);
+  if (!copy)
+  {
+    return ("");
+  }
+  
+  memcpy(copy, text, n);
+  return (copy);
+}
+
+const char* FrozenRow(usize row, void* userdata)
+{
+  const FrozenRows& rows  = *(const FrozenRows*)userdata;
+  return (row - rows.m_First < rows.m_Count ? rows.m_Texts[row - rows.m_First] : "");
+}
+
+// copies the lines in view into a model of their own, with the cursor
+// hidden if it is outside of them.
+const TextModel*  FreezeTextModel(IN_OUT BumpAllocator& arena, const TextModel& model, u32 rows)
+{
+  usize first   = model.m_FirstLine < model.Lines() ? model.m_FirstLine : model.Lines() - 1;
+  usize last    = first + rows < model.Lines() ? first + rows : model.Lines();
+  usize begin   = model.LineStart(first);
+  usize end     = begin;
+  for (usize line = first; line < last; ++line)
+  {
+    end = model.LineStart(line) + model.LineLength(line);
+  }
+  
+  TextModel*  copy    = (TextModel*)arena.Alloc(sizeof(TextModel));
+  char*       buffer  = (char*)arena.Alloc(end - begin + 1);
+  usize*      lines   = (usize*)arena.Alloc(rows * sizeof(usize));
+  if (!copy || !buffer || !lines)
+  {
+    return (nullptr);
+  }
+  
+  *copy = TextModel(buffer, end - begin, lines, rows);
+  model.Read(begin, buffer, end - begin + 1);
+  copy->m_GapStart = end - begin;
+  for (usize line = first + 1; line < last; ++line)
+  {
+    lines[copy->m_LinesBefore++] = model.LineStart(line) - begin;
+  }
+  
+  copy->m_FirstColumn = model.m_FirstColumn;
+  copy->m_Selected = model.m_Selected && model.m_Cursor >= begin && model.m_Cursor <= end;
+  copy->m_Cursor = copy->m_Selected ? model.m_Cursor - begin : 0;
+  
+  return (copy);
+}
+
+// makes a panel independent of everything its widgets pointed at, so that
+// it can be rendered while the next frame is built.
+void  FreezePanel(IN_OUT UIPanel& panel, IN_OUT BumpAllocator& arena)
+{
+  for (usize i = 0; i < panel.m_ElemsLength; ++i)
+  {
+    UIElem& elem  = panel.m_Elems[i];
+    switch (elem.m_Any.m_Type)
+    {
+    case LABEL:
+    case BUTTON:
+    case HOLD_BUTTON:
+      elem.m_Button.m_Text = FreezeText(arena, elem.m_Button.m_Text);
+      break;
+    case SLIDER:
+      elem.m_Slider.m_Text = FreezeText(arena, elem.m_Slider.m_Text);
+      break;
+    case TEXT_FIELD:
+    {
+      elem.m_TextField.m_Text = FreezeText(arena, elem.m_TextField.m_Text);
+      TFData* data  = (TFData*)arena.Alloc(sizeof(TFData));
+      if (data)
+      {
+        *data = *elem.m_TextField.m_TFData;
+        data->m_Buffer = (char*)FreezeText(arena, data->m_Buffer);
+        data->m_Capacity = data->m_Length + 1;
+        elem.m_TextField.m_TFData = data;
+      }
+      break;
+    }
+    case TEXT_EDITOR:
+    {
+      elem.m_TextEditor.m_Text = FreezeText(arena, elem.m_TextEditor.m_Text);
+      const TextModel*  model = FreezeTextModel(arena, *elem.m_TextEditor.m_Model, elem.m_TextEditor.m_Rows);
+      if (model)
+      {
+        elem.m_TextEditor.m_Model = model;
+      }
+      break;
+    }
+    case LIST:
+    {
+      ListState*  state = (ListState*)arena.Alloc(sizeof(ListState));
+      FrozenRows* rows  = (FrozenRows*)arena.Alloc(sizeof(FrozenRows));
+      if (!state || !rows)
+      {
+        break;
+      }
+      
+      *state = *elem.m_List.m_State;
+      elem.m_List.m_State = state;
+      ListRange(elem, rows->m_First, rows->m_Count);
+      rows->m_Count -= rows->m_First;
+      rows->m_Texts = (const char**)arena.Alloc(rows->m_Count * sizeof(const char*));
+      for (usize row = 0; row < rows->m_Count; ++row)
+      {
+        const char* text  = elem.m_List.m_Row(rows->m_First + row, elem.m_List.m_Userdata);
+        if (rows->m_Texts)
+        {
+          rows->m_Texts[row] = FreezeText(arena, text);
+        }
+      }
+      rows->m_Count = rows->m_Texts ? rows->m_Count : 0;
+      
+      elem.m_List.m_Row = FrozenRow;
+      elem.m_List.m_Userdata = rows;
+      break;
+    }
+    default:
+      break;
+    }
+  }
+}
+
+void  AddFrameStats(IN_OUT FrameStats& stats, const FrameStats& add)
+{
+  stats.m_DrawCalls += add.m_DrawCalls;
+  stats.m_ColorChanges += add.m_ColorChanges;
+  stats.m_TexturesCreated += add.m_TexturesCreated;
+  stats.m_Rasterizations += add.m_Rasterizations;
+  stats.m_Measurements += add.m_Measurements;
+  stats.m_Rects += add.m_Rects;
+  stats.m_Texts += add.m_Texts;
+  stats.m_Sprites += add.m_Sprites;
+  stats.m_PanelRenders += add.m_PanelRenders;
+  stats.m_PanelCacheHits += add.m_PanelCacheHits;
+  stats.m_Widgets += add.m_Widgets;
+}
+
+using RenderElemFn = void (*)(const UIPanel&, DrawList&, usize, bool);
+
+void  RenderInactive(const UIPanel& panel, DrawList& list, usize i, bool hovered)
+{
+  (void)hovered;
+  
+  const UIElem& elem  = panel.m_Elems[i];
+  list.Rect(elem.m_Any.m_X, elem.m_Any.m_Y, elem.m_Any.m_W, elem.m_Any.m_H, INACTIVE_COLOR);
+}
+
+void  RenderLabel(const UIPanel& panel, DrawList& list, usize i, bool hovered)
+{
+  (void)hovered;
+  
+  const UIElem& elem  = panel.m_Elems[i];
+  list.Text(elem.m_Any.m_X, elem.m_Any.m_Y, elem.m_Any.m_W, elem.m_Any.m_H, elem.m_Label.m_Text, LABEL_TEXT_COLOR);
+}
+
+void  RenderButton(const UIPanel& panel, DrawList& list, usize i, bool hovered)
+{
+  const UIElem& elem  = panel.m_Elems[i];
+  i32           pad   = g_Conf.m_UIPad;
+  i32           x     = elem.m_Any.m_X;
+  i32           y     = elem.m_Any.m_Y;
+  i32           w     = elem.m_Any.m_W;
+  i32           h     = elem.m_Any.m_H;
+  
+  Color buttonColor = BUTTON_COLOR;
+  Color textColor   = BUTTON_TEXT_COLOR;
+  if (hovered)
+  {
+    if (MouseDown(SDL_BUTTON_LEFT))
+    {
+      buttonColor = BUTTON_PRESS_COLOR;
+      textColor   = BUTTON_TEXT_PRESS_COLOR;
+    }
+    else
+    {
+      buttonColor = BUTTON_HOVER_COLOR;
+      textColor   = BUTTON_TEXT_HOVER_COLOR;
+    }
+  }
+  
+  list.Rect(x, y, w, h, buttonColor);
+  list.Text(x + pad, y + pad, w - 2 * pad, h - 2 * pad, elem.m_Button.m_Text, textColor);
+}
+
+void  RenderSlider(const UIPanel& panel, DrawList& list, usize i, bool hovered)
+{
+  const UIElem& elem  = panel.m_Elems[i];
+  i32           pad   = g_Conf.m_UIPad;
+  i32           x     = elem.m_Any.m_X;
+  i32           y     = elem.m_Any.m_Y;
+  i32           w     = elem.m_Any.m_W;
+  i32           h     = elem.m_Any.m_H;
+  
+  Color sliderColor = SLIDER_COLOR;
+  Color textColor   = SLIDER_TEXT_COLOR;
+  Color barColor    = SLIDER_BAR_COLOR;
+  if (hovered)
+  {
+    if (MouseDown(SDL_BUTTON_LEFT))
+    {
+      sliderColor = SLIDER_PRESS_COLOR;
+      textColor   = SLIDER_TEXT_PRESS_COLOR;
+      barColor    = SLIDER_BAR_PRESS_COLOR;
+    }
+    else
+    {
+      sliderColor = SLIDER_HOVER_COLOR;
+      textColor   = SLIDER_TEXT_HOVER_COLOR;
+      barColor    = SLIDER_BAR_HOVER_COLOR;
+    }
+  }
+  
+  list.Rect(x, y, w, h, sliderColor);
+  list.Rect(x, y, elem.m_Slider.m_Value * w, h, barColor);
+  list.Text(x + pad, y + pad, w - 2 * pad, h - 2 * pad, elem.m_Slider.m_Text, textColor);
+}
+
+void  RenderTextField(const UIPanel& panel, DrawList& list, usize i, bool hovered)
+{
+  const UIElem& elem  = panel.m_Elems[i];
+  i32           pad   = g_Conf.m_UIPad;
+  i32           x     = elem.m_Any.m_X;
+  i32           y     = elem.m_Any.m_Y;
+  i32           w     = elem.m_Any.m_W;
+  i32           h     = elem.m_Any.m_H;
+  
+  Color textFieldColor        = TEXT_FIELD_COLOR;
+  Color textFieldTextColor    = TEXT_FIELD_TEXT_COLOR;
+  Color textFieldBarColor     = TEXT_FIELD_TEXT_COLOR;
+  Color textFieldPromptColor  = TEXT_FIELD_PROMPT_COLOR;
+  if (hovered)
+  {
+    if (MouseDown(SDL_BUTTON_LEFT))
+    {
+      textFieldColor        = TEXT_FIELD_PRESS_COLOR;
+      textFieldTextColor    = TEXT_FIELD_TEXT_COLOR;
+      textFieldBarColor     = TEXT_FIELD_BAR_COLOR;
+      textFieldPromptColor  = TEXT_FIELD_PROMPT_COLOR;
+    }
+    else
+    {
+      textFieldColor        = TEXT_FIELD_HOVER_COLOR;
+      textFieldTextColor    = TEXT_FIELD_TEXT_HOVER_COLOR;
+      textFieldBarColor     = TEXT_FIELD_BAR_HOVER_COLOR;
+      textFieldPromptColor  = TEXT_FIELD_PROMPT_HOVER_COLOR;
+    }
+  }
+  
+  list.Rect(x, y, w, h, textFieldColor);
+  
+  const TFData& data        = *elem.m_TextField.m_TFData;
+  i32           charWidth   = (w - 2 * pad) / elem.m_TextField.m_NDraw;
+  i32           charHeight  = h - 2 * pad;
+  
+  const char* text        = data.m_Length ? data.m_Buffer : elem.m_TextField.m_Text;
+  u32         textFirst   = data.m_Length ? data.m_First : 0;
+  u32         textLength  = data.m_Length ? data.m_Length : strlen(text);
+  Color       textColor   = data.m_Length ? textFieldTextColor : textFieldPromptColor;
+  
+  // the visible slice goes out as a single fixed-advance run, which is
+  // nDraw codepoints long at most.
+  u32 nDraw = elem.m_TextField.m_NDraw;
+  u32 end   = textFirst;
+  for (u32 n = 0; n < nDraw && end < textLength; ++n)
+  {
+    end = NextCodepoint(text, end, textLength);
+  }
+  
+  if (end > textFirst)
+  {
+    list.TextRun(x + pad, y + pad, charWidth, charHeight, &text[textFirst], end - textFirst, textColor);
+  }
+  
+  if (data.m_Selected)
+  {
+    list.Rect(
+      x + pad + CountCodepoints(data.m_Buffer, data.m_First, data.m_Cursor) * charWidth,
+      y + pad,
+      g_Conf.m_UITextFieldBar,
+      charHeight,
+      textFieldBarColor
+    );
+  }
+}
+
+void  RenderList(const UIPanel& panel, DrawList& list, usize i, bool hovered)
+{
+  const UIElem&     elem    = panel.m_Elems[i];
+  const ListState&  state   = *elem.m_List.m_State;
+  i32               pad     = g_Conf.m_UIPad;
+  i32               x       = elem.m_Any.m_X;
+  i32               y       = elem.m_Any.m_Y;
+  i32               w       = elem.m_Any.m_W;
+  i32               h       = elem.m_Any.m_H;
+  i32               rowH    = elem.m_List.m_RowH;
+  i64               content = (i64)elem.m_List.m_Count * rowH;
+  i32               bar     = content > h ? g_Conf.m_UIScrollBar : 0;
+  
+  list.Rect(x, y, w, h, LIST_COLOR);
+  
+  SDL_Point m         = PanelMouse(panel);
+  usize     mouseRow  = hovered && m.x < x + w - bar ? (m.y - y + state.m_Scroll) / rowH : elem.m_List.m_Count;
+  
+  // rows scroll under a clip, so partially visible ones are cut off.
+  SDL_Rect  rows  {x, y, w - bar, h};
+  list.PushClip(rows);
+  
+  usize first {};
+  usize last  {};
+  ListRange(elem, first, last);
+  for (usize row = first; row < last; ++row)
+  {
+    i32 rowY  = y + (i32)(row * rowH) - state.m_Scroll;
+    if (state.m_HasSelection && row == state.m_Selected)
+    {
+      list.Rect(x, rowY, w - bar, rowH, LIST_ROW_SELECTED_COLOR);
+    }
+    else if (row == mouseRow)
+    {
+      list.Rect(x, rowY, w - bar, rowH, LIST_ROW_HOVER_COLOR);
+    }
+    
+    const char* text  = elem.m_List.m_Row(row, elem.m_List.m_Userdata);
+    i32         textW {};
+    i32         textH {};
+    TextSize(panel.m_Font, text, textW, textH);
+    list.Text(x + pad, rowY + (rowH - textH) / 2, textW, textH, text, LIST_TEXT_COLOR);
+  }
+  
+  list.PopClip();
+  
+  if (bar)
+  {
+    i32 thumb   = ListThumb(h, content);
+    i32 thumbY  = y + (i32)((i64)state.m_Scroll * (h - thumb) / (content - h));
+    list.Rect(x + w - bar, thumbY, bar, thumb, LIST_BAR_COLOR);
+  }
+}
+
+// one or two runs per visible line, split where the gap falls.
+void  RenderTextEditor(const UIPanel& panel, DrawList& list, usize i, bool hovered)
+{
+  const UIElem&     elem  = panel.m_Elems[i];
+  const TextModel&  model = *elem.m_TextEditor.m_Model;
+  i32               pad   = g_Conf.m_UIPad;
+  i32               x     = elem.m_Any.m_X;
+  i32               y     = elem.m_Any.m_Y;
+  i32               w     = elem.m_Any.m_W;
+  i32               h     = elem.m_Any.m_H;
+  u32               cols  = elem.m_TextEditor.m_Cols;
+  u32               rows  = elem.m_TextEditor.m_Rows;
+  
+  Color editorColor = TEXT_FIELD_COLOR;
+  Color textColor   = TEXT_FIELD_TEXT_COLOR;
+  Color barColor    = TEXT_FIELD_BAR_COLOR;
+  if (hovered)
+  {
+    editorColor = MouseDown(SDL_BUTTON_LEFT) ? TEXT_FIELD_PRESS_COLOR : TEXT_FIELD_HOVER_COLOR;
+    textColor   = MouseDown(SDL_BUTTON_LEFT) ? TEXT_FIELD_TEXT_PRESS_COLOR : TEXT_FIELD_TEXT_HOVER_COLOR;
+    barColor    = MouseDown(SDL_BUTTON_LEFT) ? TEXT_FIELD_BAR_PRESS_COLOR : TEXT_FIELD_BAR_HOVER_COLOR;
+  }
+  
+  list.Rect(x, y, w, h, editorColor);
+  
+  i32 charWidth   = (w - 2 * pad) / (i32)cols;
+  i32 charHeight  = (h - 2 * pad) / (i32)rows;
+  
+  if (!model.Length())
+  {
+    Color promptColor = hovered ? TEXT_FIELD_PROMPT_HOVER_COLOR : TEXT_FIELD_PROMPT_COLOR;
+    u32   length      = strlen(elem.m_TextEditor.m_Text);
+    length = length < cols ? length : cols;
+    if (length)
+    {
+      list.TextRun(x + pad, y + pad, charWidth, charHeight, elem.m_TextEditor.m_Text, length, promptColor);
+    }
+  }
+  
+  usize last  = model.m_FirstLine + rows;
+  last = last < model.Lines() ? last : model.Lines();
+  for (usize line = model.m_FirstLine; line < last; ++line)
+  {
+    usize start   = model.LineStart(line);
+    usize length  = model.LineLength(line);
+    if (length <= model.m_FirstColumn)
+    {
+      continue;
+    }
+    
+    usize begin = start + model.m_FirstColumn;
+    usize end   = start + (length < model.m_FirstColumn + cols ? length : model.m_FirstColumn + cols);
+    i32   lineY = y + pad + (i32)(line - model.m_FirstLine) * charHeight;
+    
+    // text before the gap is stored as is, text after it shifted by the gap.
+    usize gap   = model.m_GapEnd - model.m_GapStart;
+    usize split = end < model.m_GapStart ? end : begin > model.m_GapStart ? begin : model.m_GapStart;
+    if (split > begin)
+    {
+      list.TextRun(x + pad, lineY, charWidth, charHeight, &model.m_Buffer[begin], split - begin, textColor);
+    }
+    if (end > split)
+    {
+      i32 runX  = x + pad + (i32)(split - begin) * charWidth;
+      list.TextRun(runX, lineY, charWidth, charHeight, &model.m_Buffer[split + gap], end - split, textColor);
+    }
+  }
+  
+  if (model.m_Selected)
+  {
+    usize line    = model.LineOf(model.m_Cursor);
+    usize column  = model.m_Cursor - model.LineStart(line);
+    if (line >= model.m_FirstLine && line < last && column >= model.m_FirstColumn && column <= model.m_FirstColumn + cols)
+    {
+      list.Rect(
+        x + pad + (i32)(column - model.m_FirstColumn) * charWidth,
+        y + pad + (i32)(line - model.m_FirstLine) * charHeight,
+        g_Conf.m_UITextFieldBar,
+        charHeight,
+        barColor
+      );
+    }
+  }
+}
+
+// indexed by UIType.
+constexpr RenderElemFn  ELEM_RENDERERS[UI_TYPES]  =
+{
+  RenderLabel,
+  RenderButton,
+  RenderSlider,
+  RenderTextField,
+  RenderButton,
+  RenderList,
+  RenderTextEditor
+};
+
+}
+
+void  TextSize(TTF_Font* font, const char* text, OUT i32& w, OUT i32& h)
+{
+  i32 generation  = SDL_AtomicGet(&Internal::g_FontGeneration);
+  if (Internal::t_FontGeneration != generation)
+  {
+    memset(Internal::t_FontMetrics, 0, sizeof(Internal::t_FontMetrics));
+    memset(Internal::t_TextSizes, 0, sizeof(Internal::t_TextSizes));
+    Internal::t_FontMetricsNext = 0;
+    Internal::t_FontGeneration = generation;
+  }
+  
+  Internal::FontMetrics*  metrics = nullptr;
+  for (usize i = 0; i < MAX_MEASURED_FONTS; ++i)
+  {
+    if (Internal::t_FontMetrics[i].m_Font == font)
+    {
+      metrics = &Internal::t_FontMetrics[i];
+      break;
+    }
+  }
+  
+  if (!metrics)
+  {
+    metrics = &Internal::t_FontMetrics[Internal::t_FontMetricsNext];
+    Internal::t_FontMetricsNext = (Internal::t_FontMetricsNext + 1) % MAX_MEASURED_FONTS;
+    
+    metrics->m_Font = font;
+    metrics->m_Advance = 0;
+    metrics->m_Height = TTF_FontHeight(font);
+    if (TTF_FontFaceIsFixedWidth(font))
+    {
+      TTF_GlyphMetrics32(font, ' ', nullptr, nullptr, nullptr, nullptr, &metrics->m_Advance);
+    }
+  }
+  
+  // fixed width fonts only need the number of codepoints.
+  if (metrics->m_Advance)
+  {
+    usize n = 0;
+    for (const char* c = text; *c; ++c)
+    {
+      n += (*c & 0xc0) != 0x80;
+    }
+    
+    w = n * metrics->m_Advance;
+    h = metrics->m_Height;
+    return;
+  }
+  
+  // the pointer narrows down the slot, the hash catches changed contents.
+  u64                       hash  = Internal::TextHash(text);
+  usize                     slot  = (hash ^ (uintptr_t)text ^ (uintptr_t)font >> 4) & (MAX_TEXT_SIZES - 1);
+  Internal::TextSizeEntry&  entry = Internal::t_TextSizes[slot];
+  if (entry.m_Font != font || entry.m_Text != text || entry.m_Hash != hash)
+  {
+    entry.m_Font = font;
+    entry.m_Text = text;
+    entry.m_Hash = hash;
+    entry.m_W = 0;
+    entry.m_H = 0;
+    TTF_SizeUTF8(font, text, &entry.m_W, &entry.m_H);
+    ++Internal::t_FrameStats->m_Measurements;
+  }
+  
+  w = entry.m_W;
+  h = entry.m_H;
+}
+
+// measurements are cached by font pointer, so this must be called after
+// TTF_CloseFont(), before another font can be opened at the same address.
+// Platform::ReleaseResources() calls it too.
+void  ForgetFonts()
+{
+  SDL_AtomicAdd(&Internal::g_FontGeneration, 1);
+}
+
+TFData::TFData(char buffer[], usize capacity)
+  : m_Buffer(buffer),
+  m_Capacity(capacity)
+{
+  memset(buffer, 0, capacity);
+}
+
+usize TextModel::Length() const
+{
+  return (m_Capacity - (m_GapEnd - m_GapStart));
+}
+
+usize TextModel::Lines() const
+{
+  return (1 + m_LinesBefore + m_LinesAfter);
+}
+
+usize TextModel::LineStart(usize line) const
+{
+  if (!line)
+  {
+    return (0);
+  }
+  
+  usize i = line - 1;
+  if (i < m_LinesBefore)
+  {
+    return (m_Lines[i]);
+  }
+  
+  return (Length() - m_Lines[m_LinesCapacity - m_LinesAfter + i - m_LinesBefore]);
+}
+
+// without the terminating newline.
+usize TextModel::LineLength(usize line) const
+{
+  usize end = line + 1 < Lines() ? LineStart(line + 1) - 1 : Length();
+  return (end - LineStart(line));
+}
+
+usize TextModel::LineOf(usize offset) const
+{
+  usize low   = 0;
+  usize high  = Lines();
+  while (high - low > 1)
+  {
+    usize mid = low + (high - low) / 2;
+    if (LineStart(mid) <= offset)
+    {
+      low = mid;
+    }
+    else
+    {
+      high = mid;
+    }
+  }
+  return (low);
+}
+
+char  TextModel::At(usize offset) const
+{
+  return (offset < m_GapStart ? m_Buffer[offset] : m_Buffer[offset + m_GapEnd - m_GapStart]);
+}
+
+// copies at most n - 1 characters and null terminates, returning the number
+// of characters copied.
+usize TextModel::Read(usize offset, OUT char dst[], usize n) const
+{
+  if (!n)
+  {
+    return (0);
+  }
+  
+  usize length  = Length();
+  usize end     = offset + n - 1 < length ? offset + n - 1 : length;
+  end = end > offset ? end : offset;
+  
+  usize split   = end < m_GapStart ? end : offset > m_GapStart ? offset : m_GapStart;
+  usize gap     = m_GapEnd - m_GapStart;
+  memcpy(dst, &m_Buffer[offset], split - offset);
+  memcpy(&dst[split - offset], &m_Buffer[split + gap], end - split);
+  dst[end - offset] = 0;
+  
+  return (end - offset);
+}
+
+bool  TextModel::Insert(char c)
+{
+  if (m_GapStart == m_GapEnd || (c == '\n' && m_LinesBefore + m_LinesAfter >= m_LinesCapacity))
+  {
+    return (false);
+  }
+  
+  Internal::MoveTextGap(*this, m_Cursor);
+  m_Buffer[m_GapStart++] = c;
+  ++m_Cursor;
+  
+  if (c == '\n')
+  {
+    m_Lines[m_LinesBefore++] = m_Cursor;
+  }
+  
+  return (true);
+}
+
+bool  TextModel::Insert(const char* str)
+{
+  for (; *str; ++str)
+  {
+    if (!Insert(*str))
+    {
+      return (false);
+    }
+  }
+  return (true);
+}
+
+bool  TextModel::Erase()
+{
+  if (!m_Cursor)
+  {
+    return (false);
+  }
+  
+  Internal::MoveTextGap(*this, m_Cursor);
+  if (m_Buffer[--m_GapStart] == '\n')
+  {
+    --m_LinesBefore;
+  }
+  --m_Cursor;
+  
+  return (true);
+}
+
+bool  TextModel::Delete()
+{
+  if (m_Cursor >= Length())
+  {
+    return (false);
+  }
+  
+  Internal::MoveTextGap(*this, m_Cursor);
+  if (m_Buffer[m_GapEnd++] == '\n')
+  {
+    --m_LinesAfter;
+  }
+  
+  return (true);
+}
+
+void  TextModel::Clear()
+{
+  m_GapStart = 0;
+  m_GapEnd = m_Capacity;
+  m_LinesBefore = 0;
+  m_LinesAfter = 0;
+  m_Cursor = 0;
+  m_FirstLine = 0;
+  m_FirstColumn = 0;
+}
+
+TextModel::TextModel(char buffer[], usize capacity, usize lines[], usize linesCapacity)
+  : m_Buffer(buffer),
+  m_Capacity(capacity),
+  m_GapEnd(capacity),
+  m_Lines(lines),
+  m_LinesCapacity(linesCapacity)
+{
+}
+
+UIPanel::UIPanel(UIElem elems[], usize elemsCapacity, TTF_Font* font, const SDL_Window* window)
+  : m_Elems(elems),
+  m_ElemsCapacity(elemsCapacity),
+  m_Font(font),
+  m_Window(window)
+{
+}
+
+UIPanel::UIPanel(UIElem elems[], const UIElemArrays& arrays, usize elemsCapacity, TTF_Font* font, const SDL_Window* window)
+  : m_Elems(elems),
+  m_ElemsCapacity(elemsCapacity),
+  m_Font(font),
+  m_Window(window),
+  m_Arrays(arrays)
+{
+}
+
+// elements live in the arena, so the panel must not outlive its reset.
+UIPanel::UIPanel(BumpAllocator& arena, usize elemsCapacity, bool arrays, TTF_Font* font, const SDL_Window* window)
+  : m_Font(font),
+  m_Window(window),
+  m_Arena(&arena)
+{
+  Internal::ReserveElems(*this, elemsCapacity ? elemsCapacity : MIN_ARENA_ELEMS, arrays);
+}
+
+void  UIPanel::Render()
+{
+  ++Internal::t_FrameStats->m_PanelRenders;
+  if (!m_Cache || !m_ElemsLength)
+  {
+    DrawList  immediate {};
+    Render(immediate);
+    return;
+  }
+  
+  // only redraw into the cached target when something visible changed.
+  // the target only needs to cover what the clip lets through.
+  SDL_Rect  bounds  = Internal::PanelBounds(*this);
+  if (m_Clip.w > 0 && m_Clip.h > 0 && !Internal::ClipRect(bounds, m_Clip))
+  {
+    return;
+  }
+  
+  u64       hash    = Internal::HashPanel(*this);
+  bool      stale   = hash != m_Cache->m_Hash || bounds.w != m_Cache->m_W || bounds.h != m_Cache->m_H;
+  
+  if (stale || !m_Cache->m_Texture)
+  {
+    if (!Platform::BeginPanelCache(*m_Cache, bounds.w, bounds.h))
+    {
+      DrawList  immediate {};
+      Render(immediate);
+      return;
+    }
+    
+    DrawList  target  {};
+    target.m_OffsetX = -bounds.x;
+    target.m_OffsetY = -bounds.y;
+    Render(target);
+    
+    Platform::EndPanelCache(*m_Cache);
+    m_Cache->m_Hash = hash;
+  }
+  else
+  {
+    ++Internal::t_FrameStats->m_PanelCacheHits;
+  }
+  
+  Platform::RenderPanelCache(*m_Cache, bounds.x, bounds.y);
+}
+
+void  UIPanel::Render(DrawList& list)
+{
+  if (!m_ElemsLength)
+  {
+    return;
+  }
+  
+  bool  clipped = m_Clip.w > 0 && m_Clip.h > 0;
+  if (clipped)
+  {
+    list.PushClip(m_Clip);
+  }
+  
+  // draw panel
+  SDL_Rect  bounds  = Internal::PanelBounds(*this);
+  list.Rect(bounds.x, bounds.y, bounds.w, bounds.h, PANEL_COLOR);
+  
+  // draw UI elements, skipping the ones no clip lets through before they
+  // measure or rasterize anything.
+  usize hovered = Internal::HoveredElem(*this, Internal::PanelMouse(*this));
+  if (!m_Arrays.m_Type)
+  {
+    for (usize i = 0; i < m_ElemsLength; ++i)
+    {
+      const UIElem& elem  = m_Elems[i];
+      if (!list.Visible(elem.m_Any.m_X, elem.m_Any.m_Y, elem.m_Any.m_W, elem.m_Any.m_H))
+      {
+        continue;
+      }
+      
+      Internal::RenderElemFn  render  = m_Elems[i].m_Any.m_Flags & Internal::INACTIVE
+        ? Internal::RenderInactive
+        : Internal::ELEM_RENDERERS[m_Elems[i].m_Any.m_Type];
+      render(*this, list, i, i == hovered);
+    }
+  }
+  else
+  {
+    // elements never overlap, so they can be drawn one type at a time.
+    for (u8 type = 0; type < Internal::UI_TYPES; ++type)
+    {
+      Internal::RenderElemFn  render  = Internal::ELEM_RENDERERS[type];
+      for (usize i = Internal::NextOfType(m_Arrays.m_Type, 0, m_ElemsLength, type);
+        i < m_ElemsLength;
+        i = Internal::NextOfType(m_Arrays.m_Type, i + 1, m_ElemsLength, type))
+      {
+        if (!list.Visible(m_Arrays.m_X[i], m_Arrays.m_Y[i], m_Arrays.m_W[i], m_Arrays.m_H[i]))
+        {
+          continue;
+        }
+        
+        if (m_Arrays.m_Flags[i] & Internal::INACTIVE)
+        {
+          Internal::RenderInactive(*this, list, i, false);
+          continue;
+        }
+        
+        render(*this, list, i, i == hovered);
+      }
+    }
+  }
+  
+  if (clipped)
+  {
+    list.PopClip();
+  }
+}
+
+void  UIPanel::Label(const char* text)
+{
+  WidgetState*  widget  = Internal::VisitWidget(*this, text);
+  
+  i32 w {};
+  i32 h {};
+  Internal::MeasureWidget(widget, m_Font, text, w, h);
+  
+  if (Internal::Culled(*this, w, h))
+  {
+    return;
+  }
+  
+  if (m_ElemsLength >= m_ElemsCapacity && !Internal::GrowElems(*this))
+  {
+    return;
+  }
+  
+  SDL_Rect  r = Internal::PlaceElem(*this, w, h);
+  
+  m_Elems[m_ElemsLength].m_Label.m_Type   = Internal::LABEL;
+  m_Elems[m_ElemsLength].m_Label.m_Flags  = Internal::INACTIVE * !m_Active;
+  m_Elems[m_ElemsLength].m_Label.m_X      = r.x;
+  m_Elems[m_ElemsLength].m_Label.m_Y      = r.y;
+  m_Elems[m_ElemsLength].m_Label.m_W      = r.w;
+  m_Elems[m_ElemsLength].m_Label.m_H      = r.h;
+  m_Elems[m_ElemsLength].m_Label.m_Text   = text;
+  Internal::MirrorElem(*this, m_ElemsLength);
+  ++m_ElemsLength;
+  ++Internal::t_FrameStats->m_Widgets;
+}
+
+bool  UIPanel::Button(const char* text)
+{
+  bool  state = false;
+  
+  WidgetState*  widget  = Internal::VisitWidget(*this, text);
+  
+  i32 w {};
+  i32 h {};
+  Internal::MeasureWidget(widget, m_Font, text, w, h);
+  w += 2 * g_Conf.m_UIPad;
+  h += 2 * g_Conf.m_UIPad;
+  
+  if (Internal::Culled(*this, w, h))
+  {
+    return (false);
+  }
+  
+  if (m_ElemsLength >= m_ElemsCapacity && !Internal::GrowElems(*this))
+  {
+    return (false);
+  }
+  
+  SDL_Rect  r = Internal::PlaceElem(*this, w, h);
+  
+  if (m_Active)
+  {
+    state = Internal::ReleasedOver(widget, Internal::PanelMouse(*this), r);
+  }
+  
+  m_Elems[m_ElemsLength].m_Button.m_Type  = Internal::BUTTON;
+  m_Elems[m_ElemsLength].m_Button.m_Flags = Internal::INACTIVE * !m_Active;
+  m_Elems[m_ElemsLength].m_Button.m_X     = r.x;
+  m_Elems[m_ElemsLength].m_Button.m_Y     = r.y;
+  m_Elems[m_ElemsLength].m_Button.m_W     = r.w;
+  m_Elems[m_ElemsLength].m_Button.m_H     = r.h;
+  m_Elems[m_ElemsLength].m_Button.m_Text  = text;
+  Internal::MirrorElem(*this, m_ElemsLength);
+  ++m_ElemsLength;
+  ++Internal::t_FrameStats->m_Widgets;
+  
+  return (state);
+}
+
+bool  UIPanel::Slider(const char* text, IN_OUT f32& value)
+{
+  bool  state = false;
+  
+  WidgetState*  widget  = Internal::VisitWidget(*this, text);
+  
+  i32 w {};
+  i32 h {};
+  Internal::MeasureWidget(widget, m_Font, text, w, h);
+  w += 2 * g_Conf.m_UIPad;
+  h += 2 * g_Conf.m_UIPad;
+  
+  if (Internal::Culled(*this, w, h))
+  {
+    return (false);
+  }
+  
+  if (m_ElemsLength >= m_ElemsCapacity && !Internal::GrowElems(*this))
+  {
+    return (false);
+  }
+  
+  SDL_Rect  r = Internal::PlaceElem(*this, w, h);
+  
+  if (m_Active)
+  {
+    SDL_Point m = Internal::PanelMouse(*this);
+    
+    if (Internal::ReleasedOver(widget, m, r))
+    {
+      value = (f32)(m.x - r.x) / r.w;
+      state = true;
+    }
+    
+    value = value < 0.0f ? 0.0f : value;
+    value = value > 1.0f ? 1.0f : value;
+  }
+  
+  m_Elems[m_ElemsLength].m_Slider.m_Type  = Internal::SLIDER;
+  m_Elems[m_ElemsLength].m_Slider.m_Flags = Internal::INACTIVE * !m_Active;
+  m_Elems[m_ElemsLength].m_Slider.m_X     = r.x;
+  m_Elems[m_ElemsLength].m_Slider.m_Y     = r.y;
+  m_Elems[m_ElemsLength].m_Slider.m_W     = r.w;
+  m_Elems[m_ElemsLength].m_Slider.m_H     = r.h;
+  m_Elems[m_ElemsLength].m_Slider.m_Text  = text;
+  m_Elems[m_ElemsLength].m_Slider.m_Value = value;
+  Internal::MirrorElem(*this, m_ElemsLength);
+  ++m_ElemsLength;
+  ++Internal::t_FrameStats->m_Widgets;
+  
+  return (state);
+}
+
+// text field assumes that m_Font is loaded with monospace font
+bool  UIPanel::TextField(const char* text, IN_OUT TFData& data, u32 nDraw)
+{
+  bool  state = false;
+  
+  i32 charWidth   {};
+  i32 charHeight  {};
+  TextSize(m_Font, " ", charWidth, charHeight);
+  
+  i32 w = nDraw * charWidth + 2 * g_Conf.m_UIPad;
+  i32 h = charHeight + 2 *g_Conf.m_UIPad;
+  
+  if (Internal::Culled(*this, w, h))
+  {
+    return (false);
+  }
+  
+  if (m_ElemsLength >= m_ElemsCapacity && !Internal::GrowElems(*this))
+  {
+    return (false);
+  }
+  
+  SDL_Rect  r = Internal::PlaceElem(*this, w, h);
+  
+  if (m_Active)
+  {
+    if (MouseReleased(SDL_BUTTON_LEFT))
+    {
+      SDL_Point m = Internal::PanelMouse(*this);
+      if (m.x >= r.x && m.y >= r.y && m.x < r.x + r.w && m.y < r.y + r.h)
+      {
+        data.m_Selected = true;
+      }
+      else
+      {
+        data.m_Selected = false;
+      }
+    }
+    
+    if (data.m_Selected)
+    {
+      if (KeyPressed(SDLK_LEFT))
+      {
+        data.m_Cursor = Internal::PrevCodepoint(data.m_Buffer, data.m_Cursor);
+      }
+      
+      if (KeyPressed(SDLK_RIGHT))
+      {
+        data.m_Cursor = Internal::NextCodepoint(data.m_Buffer, data.m_Cursor, data.m_Length);
+      }
+      
+      if (KeyPressed(SDLK_UP))
+      {
+        data.m_Cursor = 0;
+      }
+      
+      if (KeyPressed(SDLK_DOWN))
+      {
+        data.m_Cursor = data.m_Length;
+      }
+      
+      // typed text is inserted one whole codepoint at a time, in order.
+      for (const char* c = TypedText(); *c;)
+      {
+        const char* next  = c + 1;
+        while ((*next & 0xc0) == 0x80)
+        {
+          ++next;
+        }
+        
+        u32 n = next - c;
+        if ((u8)*c >= 0x20 && *c != 0x7f && data.m_Length + n < data.m_Capacity)
+        {
+          state = true;
+          
+          memmove(
+            &data.m_Buffer[data.m_Cursor + n],
+            &data.m_Buffer[data.m_Cursor],
+            data.m_Length - data.m_Cursor
+          );
+          memcpy(&data.m_Buffer[data.m_Cursor], c, n);
+          
+          data.m_Cursor += n;
+          data.m_Length += n;
+          data.m_Buffer[data.m_Length] = 0;
+        }
+        c = next;
+      }
+      
+      if (KeyPressed(SDLK_BACKSPACE) && data.m_Cursor)
+      {
+        state = true;
+        
+        u32 prev  = Internal::PrevCodepoint(data.m_Buffer, data.m_Cursor);
+        memmove(
+          &data.m_Buffer[prev],
+          &data.m_Buffer[data.m_Cursor],
+          data.m_Length - data.m_Cursor
+        );
+        
+        data.m_Length -= data.m_Cursor - prev;
+        data.m_Cursor = prev;
+        data.m_Buffer[data.m_Length] = 0;
+      }
+      
+      // scroll so that the cursor stays within nDraw codepoints of m_First.
+      data.m_First = data.m_Cursor < data.m_First ? data.m_Cursor : data.m_First;
+      while (nDraw && Internal::CountCodepoints(data.m_Buffer, data.m_First, data.m_Cursor) >= nDraw)
+      {
+        data.m_First = Internal::NextCodepoint(data.m_Buffer, data.m_First, data.m_Length);
+      }
+    }
+  }
+  
+  m_Elems[m_ElemsLength].m_TextField.m_Type   = Internal::TEXT_FIELD;
+  m_Elems[m_ElemsLength].m_TextField.m_Flags  = Internal::INACTIVE * !m_Active;
+  m_Elems[m_ElemsLength].m_TextField.m_X      = r.x;
+  m_Elems[m_ElemsLength].m_TextField.m_Y      = r.y;
+  m_Elems[m_ElemsLength].m_TextField.m_W      = r.w;
+  m_Elems[m_ElemsLength].m_TextField.m_H      = r.h;
+  m_Elems[m_ElemsLength].m_TextField.m_Text   = text;
+  m_Elems[m_ElemsLength].m_TextField.m_TFData = &data;
+  m_Elems[m_ElemsLength].m_TextField.m_NDraw  = nDraw;
+  Internal::MirrorElem(*this, m_ElemsLength);
+  ++m_ElemsLength;
+  ++Internal::t_FrameStats->m_Widgets;
+  
+  return (state);
+}
+
+bool  UIPanel::HoldButton(const char* text)
+{
+  bool  state = false;
+  
+  WidgetState*  widget  = Internal::VisitWidget(*this, text);
+  
+  i32 w {};
+  i32 h {};
+  Internal::MeasureWidget(widget, m_Font, text, w, h);
+  w += 2 * g_Conf.m_UIPad;
+  h += 2 * g_Conf.m_UIPad;
+  
+  if (Internal::Culled(*this, w, h))
+  {
+    return (false);
+  }
+  
+  if (m_ElemsLength >= m_ElemsCapacity && !Internal::GrowElems(*this))
+  {
+    return (false);
+  }
+  
+  SDL_Rect  r = Internal::PlaceElem(*this, w, h);
+  
+  if (m_Active)
+  {
+    state = Internal::ReleasedOver(widget, Internal::PanelMouse(*this), r);
+  }
+  
+  m_Elems[m_ElemsLength].m_Button.m_Type  = Internal::HOLD_BUTTON;
+  m_Elems[m_ElemsLength].m_Button.m_Flags = Internal::INACTIVE * !m_Active;
+  m_Elems[m_ElemsLength].m_Button.m_X     = r.x;
+  m_Elems[m_ElemsLength].m_Button.m_Y     = r.y;
+  m_Elems[m_ElemsLength].m_Button.m_W     = r.w;
+  m_Elems[m_ElemsLength].m_Button.m_H     = r.h;
+  m_Elems[m_ElemsLength].m_Button.m_Text  = text;
+  Internal::MirrorElem(*this, m_ElemsLength);
+  ++m_ElemsLength;
+  ++Internal::t_FrameStats->m_Widgets;
+  
+  return (state);
+}
+
+// the F variants format their text into g_Conf.m_TextArena, so that it
+// needs no storage of its own.
+void  UIPanel::LabelF(const char* format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  const char* text  = Internal::FormatText(format, args);
+  va_end(args);
+  
+  Label(text);
+}
+
+bool  UIPanel::ButtonF(const char* format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  const char* text  = Internal::FormatText(format, args);
+  va_end(args);
+  
+  return (Button(text));
+}
+
+bool  UIPanel::SliderF(IN_OUT f32& value, const char* format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  const char* text  = Internal::FormatText(format, args);
+  va_end(args);
+  
+  return (Slider(text, value));
+}
+
+bool  UIPanel::HoldButtonF(const char* format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  const char* text  = Internal::FormatText(format, args);
+  va_end(args);
+  
+  return (HoldButton(text));
+}
+
+// multi-line counterpart of TextField for large text, see TextModel. also
+// assumes a monospace m_Font.
+bool  UIPanel::TextEditor(const char* text, IN_OUT TextModel& model, u32 cols, u32 rows)
+{
+  bool  state = false;
+  cols = cols ? cols : 1;
+  rows = rows ? rows : 1;
+  
+  i32 charWidth   {};
+  i32 charHeight  {};
+  TextSize(m_Font, " ", charWidth, charHeight);
+  
+  i32 w = cols * charWidth + 2 * g_Conf.m_UIPad;
+  i32 h = rows * charHeight + 2 * g_Conf.m_UIPad;
+  
+  if (Internal::Culled(*this, w, h))
+  {
+    return (false);
+  }
+  
+  if (m_ElemsLength >= m_ElemsCapacity && !Internal::GrowElems(*this))
+  {
+    return (false);
+  }
+  
+  SDL_Rect  r = Internal::PlaceElem(*this, w, h);
+  
+  if (m_Active)
+  {
+    if (MouseReleased(SDL_BUTTON_LEFT))
+    {
+      SDL_Point m = Internal::PanelMouse(*this);
+      model.m_Selected = m.x >= r.x && m.y >= r.y && m.x < r.x + r.w && m.y < r.y + r.h;
+      
+      // clicks place the cursor at the nearest character boundary.
+      if (model.m_Selected && charWidth && charHeight)
+      {
+        usize line    = model.m_FirstLine + (m.y - r.y - g_Conf.m_UIPad) / charHeight;
+        line = line < model.Lines() ? line : model.Lines() - 1;
+        
+        usize column  = model.m_FirstColumn + (m.x - r.x - g_Conf.m_UIPad + charWidth / 2) / charWidth;
+        usize length  = model.LineLength(line);
+        model.m_Cursor = model.LineStart(line) + (column < length ? column : length);
+      }
+    }
+    
+    if (model.m_Selected)
+    {
+      usize line    = model.LineOf(model.m_Cursor);
+      usize column  = model.m_Cursor - model.LineStart(line);
+      usize target  = line;
+      
+      if (KeyPressed(SDLK_LEFT))
+      {
+        model.m_Cursor -= model.m_Cursor > 0;
+      }
+      
+      if (KeyPressed(SDLK_RIGHT))
+      {
+        model.m_Cursor += model.m_Cursor < model.Length();
+      }
+      
+      if (KeyPressed(SDLK_HOME))
+      {
+        model.m_Cursor = model.LineStart(line);
+      }
+      
+      if (KeyPressed(SDLK_END))
+      {
+        model.m_Cursor = model.LineStart(line) + model.LineLength(line);
+      }
+      
+      target -= KeyPressed(SDLK_UP) && target > 0;
+      target += KeyPressed(SDLK_DOWN) && target + 1 < model.Lines();
+      target = KeyPressed(SDLK_PAGEUP) ? (target > rows ? target - rows : 0) : target;
+      target = KeyPressed(SDLK_PAGEDOWN) ? (target + rows < model.Lines() ? target + rows : model.Lines() - 1) : target;
+      if (target != line)
+      {
+        usize length  = model.LineLength(target);
+        model.m_Cursor = model.LineStart(target) + (column < length ? column : length);
+      }
+      
+      // lines are laid out in bytes, so only ASCII is taken.
+      for (const char* c = TypedText(); *c; ++c)
+      {
+        if (isprint((u8)*c))
+        {
+          state |= model.Insert(*c);
+        }
+      }
+      
+      if (KeyPressed(SDLK_RETURN))
+      {
+        state |= model.Insert('\n');
+      }
+      
+      if (KeyPressed(SDLK_BACKSPACE))
+      {
+        state |= model.Erase();
+      }
+      
+      if (KeyPressed(SDLK_DELETE))
+      {
+        state |= model.Delete();
+      }
+    }
+    
+    // keep the cursor in view.
+    usize line    = model.LineOf(model.m_Cursor);
+    usize column  = model.m_Cursor - model.LineStart(line);
+    model.m_FirstLine = line < model.m_FirstLine ? line : model.m_FirstLine;
+    model.m_FirstLine = line >= model.m_FirstLine + rows ? line - rows + 1 : model.m_FirstLine;
+    model.m_FirstColumn = column < model.m_FirstColumn ? column : model.m_FirstColumn;
+    model.m_FirstColumn = column >= model.m_FirstColumn + cols ? column - cols + 1 : model.m_FirstColumn;
+  }
+  
+  m_Elems[m_ElemsLength].m_TextEditor.m_Type  = Internal::TEXT_EDITOR;
+  m_Elems[m_ElemsLength].m_TextEditor.m_Flags = Internal::INACTIVE * !m_Active;
+  m_Elems[m_ElemsLength].m_TextEditor.m_X     = r.x;
+  m_Elems[m_ElemsLength].m_TextEditor.m_Y     = r.y;
+  m_Elems[m_ElemsLength].m_TextEditor.m_W     = r.w;
+  m_Elems[m_ElemsLength].m_TextEditor.m_H     = r.h;
+  m_Elems[m_ElemsLength].m_TextEditor.m_Cols  = cols;
+  m_Elems[m_ElemsLength].m_TextEditor.m_Rows  = rows;
+  m_Elems[m_ElemsLength].m_TextEditor.m_Text  = text;
+  m_Elems[m_ElemsLength].m_TextEditor.m_Model = &model;
+  Internal::MirrorElem(*this, m_ElemsLength);
+  ++m_ElemsLength;
+  ++Internal::t_FrameStats->m_Widgets;
+  
+  return (state);
+}
+
+// rows are only requested while in view, so a frame costs the same for ten
+// items as for a hundred thousand. the row callback must stay valid until
+// the panel is rendered.
+bool  UIPanel::List(IN_OUT ListState& state, usize count, i32 rowH, i32 w, i32 h, const char* (*row)(usize, void*), void* userdata)
+{
+  bool  picked  = false;
+  rowH = rowH > 0 ? rowH : 1;
+  
+  if (Internal::Culled(*this, w, h))
+  {
+    return (false);
+  }
+  
+  if (m_ElemsLength >= m_ElemsCapacity && !Internal::GrowElems(*this))
+  {
+    return (false);
+  }
+  
+  SDL_Rect  r = Internal::PlaceElem(*this, w, h);
+  
+  i64 content   = (i64)count * rowH;
+  i64 maxScroll = content > r.h ? content - r.h : 0;
+  i64 scroll    = state.m_Scroll;
+  i32 bar       = maxScroll ? g_Conf.m_UIScrollBar : 0;
+  maxScroll = maxScroll < INT32_MAX ? maxScroll : INT32_MAX;
+  
+  if (m_Active)
+  {
+    SDL_Point m       = Internal::PanelMouse(*this);
+    bool      inside  = m.x >= r.x && m.y >= r.y && m.x < r.x + r.w && m.y < r.y + r.h;
+    if (inside)
+    {
+      scroll -= (i64)MouseWheel() * rowH * LIST_WHEEL_ROWS;
+    }
+    
+    if (inside && m.x >= r.x + r.w - bar)
+    {
+      // the bar jumps to the cursor and follows it while held.
+      if (MouseDown(SDL_BUTTON_LEFT))
+      {
+        i32 thumb = Internal::ListThumb(r.h, content);
+        i64 track = r.h - thumb > 0 ? r.h - thumb : 1;
+        scroll = (i64)(m.y - r.y - thumb / 2) * maxScroll / track;
+      }
+    }
+    else if (inside && MouseReleased(SDL_BUTTON_LEFT))
+    {
+      scroll = scroll < 0 ? 0 : scroll;
+      usize index = (m.y - r.y + scroll) / rowH;
+      if (index < count)
+      {
+        state.m_Selected = index;
+        state.m_HasSelection = true;
+        picked = true;
+      }
+    }
+  }
+  
+  scroll = scroll > maxScroll ? maxScroll : scroll;
+  state.m_Scroll = scroll < 0 ? 0 : scroll;
+  
+  m_Elems[m_ElemsLength].m_List.m_Type      = Internal::LIST;
+  m_Elems[m_ElemsLength].m_List.m_Flags     = Internal::INACTIVE * !m_Active;
+  m_Elems[m_ElemsLength].m_List.m_X         = r.x;
+  m_Elems[m_ElemsLength].m_List.m_Y         = r.y;
+  m_Elems[m_ElemsLength].m_List.m_W         = r.w;
+  m_Elems[m_ElemsLength].m_List.m_H         = r.h;
+  m_Elems[m_ElemsLength].m_List.m_RowH      = rowH;
+  m_Elems[m_ElemsLength].m_List.m_Count     = count;
+  m_Elems[m_ElemsLength].m_List.m_State     = &state;
+  m_Elems[m_ElemsLength].m_List.m_Row       = row;
+  m_Elems[m_ElemsLength].m_List.m_Userdata  = userdata;
+  Internal::MirrorElem(*this, m_ElemsLength);
+  ++m_ElemsLength;
+  ++Internal::t_FrameStats->m_Widgets;
+  
+  return (picked);
+}
+
+// containers nest, with the outermost one placed at the panel cursor like
+// a widget. the tree is solved when the outermost container ends.
+void  UIPanel::BeginLayout(u64 id, LayoutType type, const LayoutStyle& style)
+{
+  if (!m_Layout || m_Layout->m_StackLength >= MAX_LAYOUT_DEPTH)
+  {
+    return;
+  }
+  
+  Layout& layout  = *m_Layout;
+  u32     index   = Internal::NO_NODE;
+  if (!layout.m_StackLength)
+  {
+    layout.m_RootX = m_X;
+    layout.m_RootY = m_Y;
+    index = Internal::VisitLayoutNode(layout, id, type, style);
+  }
+  else if (layout.m_Stack[layout.m_StackLength - 1] != Internal::NO_NODE)
+  {
+    u64 parentID  = layout.m_Nodes[layout.m_Stack[layout.m_StackLength - 1]].m_ID;
+    index = Internal::VisitLayoutNode(layout, Internal::HashMix(parentID, id), type, style);
+  }
+  
+  layout.m_Stack[layout.m_StackLength++] = index;
+  layout.m_NextStyle = LayoutStyle{};
+}
+
+void  UIPanel::EndLayout()
+{
+  if (!m_Layout || !m_Layout->m_StackLength)
+  {
+    return;
+  }
+  
+  Layout& layout  = *m_Layout;
+  u32     index   = layout.m_Stack[--layout.m_StackLength];
+  if (index == Internal::NO_NODE)
+  {
+    return;
+  }
+  
+  Internal::MeasureLayoutNode(layout, index);
+  if (layout.m_StackLength)
+  {
+    return;
+  }
+  
+  LayoutNode& root  = layout.m_Nodes[index];
+  SDL_Rect    cell  {layout.m_RootX, layout.m_RootY, root.m_PrefW, root.m_PrefH};
+  Internal::SolveLayoutNode(*this, layout, index, cell, ALIGN_FILL);
+  
+  if (m_Horizontal)
+  {
+    m_X += root.m_Rect.w;
+  }
+  else
+  {
+    m_Y += root.m_Rect.h;
+  }
+}
+
+// applies to the next widget inside a layout only.
+void  UIPanel::NextLayoutStyle(const LayoutStyle& style)
+{
+  if (m_Layout)
+  {
+    m_Layout->m_NextStyle = style;
+  }
+}
+
+// forgets nodes which were not used during the frame that just ended.
+void  Layout::BeginFrame()
+{
+  for (usize i = 0; i < m_NodesCapacity; ++i)
+  {
+    while (m_Nodes[i].m_ID && m_Nodes[i].m_Frame != m_Frame)
+    {
+      Internal::RemoveLayoutNode(*this, i);
+    }
+  }
+  
+  ++m_Frame;
+  m_StackLength = 0;
+  m_NextStyle = LayoutStyle{};
+}
+
+Layout::Layout(LayoutNode nodes[], usize nodesCapacity)
+  : m_Nodes(nodes),
+  m_NodesCapacity(nodesCapacity)
+{
+  memset(nodes, 0, nodesCapacity * sizeof(LayoutNode));
+}
+
+void  WidgetStore::PushID(u64 id)
+{
+  if (m_IDStackLength >= MAX_ID_DEPTH)
+  {
+    return;
+  }
+  
+  u64 parent  = m_IDStackLength ? m_IDStack[m_IDStackLength - 1] : 0;
+  m_IDStack[m_IDStackLength++] = Internal::HashMix(parent, id);
+}
+
+void  WidgetStore::PushID(const char* str)
+{
+  PushID(HashString(str));
+}
+
+void  WidgetStore::PopID()
+{
+  m_IDStackLength -= m_IDStackLength > 0;
+}
+
+// widgets with the same label in the same scope share their state, push an
+// ID around them to tell them apart.
+u64 WidgetStore::ID(const char* label) const
+{
+  u64 parent  = m_IDStackLength ? m_IDStack[m_IDStackLength - 1] : 0;
+  u64 id      = Internal::HashMix(parent, Internal::TextID(label));
+  return (id ? id : 1);
+}
+
+// returned states stay in place until the next BeginFrame(). returns
+// nullptr when the store is full.
+WidgetState*  WidgetStore::Get(u64 id)
+{
+  if (!m_StatesCapacity)
+  {
+    return (nullptr);
+  }
+  
+  id = id ? id : 1;
+  usize mask  = m_StatesCapacity - 1;
+  usize slot  = id & mask;
+  while (m_States[slot].m_ID && m_States[slot].m_ID != id)
+  {
+    slot = (slot + 1) & mask;
+  }
+  
+  WidgetState&  state = m_States[slot];
+  if (!state.m_ID)
+  {
+    if (4 * (m_StatesLength + 1) > 3 * m_StatesCapacity)
+    {
+      return (nullptr);
+    }
+    
+    state.m_ID = id;
+    ++m_StatesLength;
+  }
+  
+  state.m_Frame = m_Frame;
+  return (&state);
+}
+
+void  WidgetStore::BeginFrame()
+{
+  for (usize i = 0; i < m_StatesCapacity; ++i)
+  {
+    while (m_States[i].m_ID && m_States[i].m_Frame != m_Frame)
+    {
+      Internal::RemoveWidgetState(*this, i);
+    }
+  }
+  
+  ++m_Frame;
+  m_IDStackLength = 0;
+}
+
+WidgetStore::WidgetStore(WidgetState states[], usize statesCapacity)
+  : m_States(states),
+  m_StatesCapacity(statesCapacity)
+{
+  memset(states, 0, statesCapacity * sizeof(WidgetState));
+}
+
+// if the arena is too small, the store stays empty and Get() fails.
+WidgetStore::WidgetStore(BumpAllocator& arena, usize statesCapacity)
+{
+  m_States = (WidgetState*)arena.Alloc(statesCapacity * sizeof(WidgetState));
+  if (m_States)
+  {
+    m_StatesCapacity = statesCapacity;
+    memset(m_States, 0, statesCapacity * sizeof(WidgetState));
+  }
+}
+
+// waits until the main thread hands over a frame to build, then points the
+// calling thread's input queries at that frame's input.
+void  UIPipeline::BeginBuild()
+{
+  SDL_SemWait(m_Free);
+  
+  UIFrame&  frame = m_Frames[m_Build];
+  frame.m_Arena.Reset();
+  frame.m_PanelsLength = 0;
+  frame.m_Stats = FrameStats{};
+  
+  Internal::t_Input = &frame.m_Input;
+  Internal::t_FrameStats = &frame.m_Stats;
+  Internal::t_TextArena = &frame.m_Arena;
+}
+
+// panels live in the frame's arena until it is built again.
+UIPanel*  UIPipeline::Panel(const SDL_Window* window, usize elemsCapacity)
+{
+  UIFrame&  frame = m_Frames[m_Build];
+  if (frame.m_PanelsLength >= MAX_FRAME_PANELS)
+  {
+    return (nullptr);
+  }
+  
+  void* memory  = frame.m_Arena.Alloc(sizeof(UIPanel));
+  if (!memory)
+  {
+    return (nullptr);
+  }
+  
+  frame.m_Panels[frame.m_PanelsLength] = new (memory) UIPanel(frame.m_Arena, elemsCapacity, false, m_WorkerFont, window);
+  return (frame.m_Panels[frame.m_PanelsLength++]);
+}
+
+void  UIPipeline::EndBuild()
+{
+  UIFrame&  frame = m_Frames[m_Build];
+  for (usize i = 0; i < frame.m_PanelsLength; ++i)
+  {
+    UIPanel&  panel = *frame.m_Panels[i];
+    Internal::FreezePanel(panel, frame.m_Arena);
+    panel.m_Font = m_Font;
+    panel.m_Layout = nullptr;
+    panel.m_Store = nullptr;
+  }
+  
+  Internal::t_Input = &Internal::g_Input;
+  Internal::t_FrameStats = &Internal::g_FrameStats;
+  Internal::t_TextArena = nullptr;
+  
+  SDL_SemPost(m_Built);
+}
+
+// takes the frame the worker just built for rendering and hands the other
+// one back to it, along with this frame's input. blocks if the worker is
+// running late.
+void  UIPipeline::Swap()
+{
+  SDL_SemWait(m_Built);
+  Internal::AddFrameStats(Internal::g_FrameStats, m_Frames[m_Build].m_Stats);
+  
+  m_Build ^= 1;
+  m_Frames[m_Build].m_Input = Internal::g_Input;
+  
+  SDL_SemPost(m_Free);
+}
+
+void  UIPipeline::Render()
+{
+  const UIFrame&  frame = m_Frames[m_Build ^ 1];
+  for (usize i = 0; i < frame.m_PanelsLength; ++i)
+  {
+    frame.m_Panels[i]->Render();
+  }
+}
+
+// the worker must be done with its last EndBuild().
+void  UIPipeline::Release()
+{
+  if (m_Free)
+  {
+    SDL_DestroySemaphore(m_Free);
+    m_Free = nullptr;
+  }
+  
+  if (m_Built)
+  {
+    SDL_DestroySemaphore(m_Built);
+    m_Built = nullptr;
+  }
+}
+
+// the buffer is split between both frames. the worker may start building
+// the first frame right away, it is shown after the first Swap(). if the
+// semaphores cannot be created, m_Free and m_Built are left nullptr and the
+// pipeline must not be used.
+UIPipeline::UIPipeline(u8* buffer, usize capacity, TTF_Font* font, TTF_Font* workerFont)
+  : m_Free(SDL_CreateSemaphore(1)),
+  m_Built(SDL_CreateSemaphore(0)),
+  m_Font(font),
+  m_WorkerFont(workerFont)
+{
+  if (!m_Free || !m_Built)
+  {
+    Release();
+    return;
+  }
+  
+  usize half  = Align(capacity / 2, MEMORY_ALIGN);
+  half = half > capacity / 2 ? half - MEMORY_ALIGN : half;
+  m_Frames[0].m_Arena = BumpAllocator(buffer, half);
+  m_Frames[1].m_Arena = BumpAllocator(buffer + half, capacity - half);
+}
+
+//-----------//
+// animation //
+//-----------//
+
+namespace Internal
+{
+
+// quadratic easing. ease out and the second half of ease in-out mirror the
+// curve, so that the end value is reached exactly at t = 1.
+f32 Ease(f32 t, u32 easing)
+{
+  f32 u = 1.0f - t;
+  switch (easing)
+  {
+  case EASE_IN:
+    return (t * t);
+  case EASE_OUT:
+    return (1.0f - u * u);
+  case EASE_IN_OUT:
+    return (t < 0.5f ? 2.0f * t * t : 1.0f - 2.0f * u * u);
+  default:
+    return (t);
+  }
+}
+
+#if defined(__AVX2__)
+// every curve is computed for all lanes, then picked by easing.
+__m256  Ease(__m256 t, __m256i easing)
+{
+  __m256  one   = _mm256_set1_ps(1.0f);
+  __m256  two   = _mm256_set1_ps(2.0f);
+  __m256  u     = _mm256_sub_ps(one, t);
+  __m256  in    = _mm256_mul_ps(t, t);
+  __m256  out   = _mm256_sub_ps(one, _mm256_mul_ps(u, u));
+  __m256  first = _mm256_cmp_ps(t, _mm256_set1_ps(0.5f), _CMP_LT_OQ);
+  __m256  inOut = _mm256_blendv_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_mul_ps(u, u))), _mm256_mul_ps(two, in), first);
+  
+  __m256  e = t;
+  e = _mm256_blendv_ps(e, in, _mm256_castsi256_ps(_mm256_cmpeq_epi32(easing, _mm256_set1_epi32(EASE_IN))));
+  e = _mm256_blendv_ps(e, out, _mm256_castsi256_ps(_mm256_cmpeq_epi32(easing, _mm256_set1_epi32(EASE_OUT))));
+  e = _mm256_blendv_ps(e, inOut, _mm256_castsi256_ps(_mm256_cmpeq_epi32(easing, _mm256_set1_epi32(EASE_IN_OUT))));
+  return (e);
+}
+#elif defined(__SSE2__)
+// b where mask is set, a elsewhere.
+__m128  SelectF32(__m128 a, __m128 b, __m128 mask)
+{
+  return (_mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a)));
+}
+
+__m128  Ease(__m128 t, __m128i easing)
+{
+  __m128  one   = _mm_set1_ps(1.0f);
+  __m128  two   = _mm_set1_ps(2.0f);
+  __m128  u     = _mm_sub_ps(one, t);
+  __m128  in    = _mm_mul_ps(t, t);
+  __m128  out   = _mm_sub_ps(one, _mm_mul_ps(u, u));
+  __m128  first = _mm_cmplt_ps(t, _mm_set1_ps(0.5f));
+  __m128  inOut = SelectF32(_mm_sub_ps(one, _mm_mul_ps(two, _mm_mul_ps(u, u))), _mm_mul_ps(two, in), first);
+  
+  __m128  e = t;
+  e = SelectF32(e, in, _mm_castsi128_ps(_mm_cmpeq_epi32(easing, _mm_set1_epi32(EASE_IN))));
+  e = SelectF32(e, out, _mm_castsi128_ps(_mm_cmpeq_epi32(easing, _mm_set1_epi32(EASE_OUT))));
+  e = SelectF32(e, inOut, _mm_castsi128_ps(_mm_cmpeq_epi32(easing, _mm_set1_epi32(EASE_IN_OUT))));
+  return (e);
+}
+#endif
+
+void  RemoveTween(IN_OUT Tweens& tweens, usize i)
+{
+  usize last  = --tweens.m_Length;
+  tweens.m_Start[i] = tweens.m_Start[last];
+  tweens.m_End[i] = tweens.m_End[last];
+  tweens.m_Time[i] = tweens.m_Time[last];
+  tweens.m_Duration[i] = tweens.m_Duration[last];
+  tweens.m_Easing[i] = tweens.m_Easing[last];
+  tweens.m_Target[i] = tweens.m_Target[last];
+}
+
+}
+
+// starts from the target's current value. a target should only have one
+// tween at a time, Cancel() the old one to retarget it. returns false if
+// the tweens are full.
+bool  Tweens::Add(f32* target, f32 end, f32 duration, Easing easing)
+{
+  if (duration <= 0.0f)
+  {
+    *target = end;
+    return (true);
+  }
+  
+  if (m_Length >= m_Capacity)
+  {
+    return (false);
+  }
+  
+  m_Start[m_Length] = *target;
+  m_End[m_Length] = end;
+  m_Time[m_Length] = 0.0f;
+  m_Duration[m_Length] = duration;
+  m_Easing[m_Length] = easing;
+  m_Target[m_Length] = target;
+  ++m_Length;
+  
+  return (true);
+}
+
+// turns the shorter way round, as InterpAngle() does. the end is resolved
+// here, so angles cost the same as any other value in Update().
+bool  Tweens::AddAngle(f32* target, f32 end, f32 duration, Easing easing)
+{
+  return (Add(target, *target + ShortestAngle(*target, end), duration, easing));
+}
+
+// leaves the target where the tween had moved it.
+void  Tweens::Cancel(const f32* target)
+{
+  for (usize i = 0; i < m_Length;)
+  {
+    if (m_Target[i] == target)
+    {
+      Internal::RemoveTween(*this, i);
+    }
+    else
+    {
+      ++i;
+    }
+  }
+}
+
+void  Tweens::Update(f32 dt)
+{
+  usize i = 0;
+  usize n = m_Length;
+#if defined(__AVX2__)
+  __m256  vDt = _mm256_set1_ps(dt);
+  __m256  one = _mm256_set1_ps(1.0f);
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256  duration  = _mm256_loadu_ps(&m_Duration[i]);
+    __m256  time      = _mm256_min_ps(_mm256_add_ps(_mm256_loadu_ps(&m_Time[i]), vDt), duration);
+    __m256  e         = Internal::Ease(_mm256_div_ps(time, duration), _mm256_loadu_si256((const __m256i*)&m_Easing[i]));
+    __m256  start     = _mm256_mul_ps(_mm256_loadu_ps(&m_Start[i]), _mm256_sub_ps(one, e));
+    __m256  value     = _mm256_add_ps(start, _mm256_mul_ps(_mm256_loadu_ps(&m_End[i]), e));
+    _mm256_storeu_ps(&m_Time[i], time);
+    
+    f32 lanes[8];
+    _mm256_storeu_ps(lanes, value);
+    for (usize j = 0; j < 8; ++j)
+    {
+      *m_Target[i + j] = lanes[j];
+    }
+  }
+#elif defined(__SSE2__)
+  __m128  vDt = _mm_set1_ps(dt);
+  __m128  one = _mm_set1_ps(1.0f);
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128  duration  = _mm_loadu_ps(&m_Duration[i]);
+    __m128  time      = _mm_min_ps(_mm_add_ps(_mm_loadu_ps(&m_Time[i]), vDt), duration);
+    __m128  e         = Internal::Ease(_mm_div_ps(time, duration), _mm_loadu_si128((const __m128i*)&m_Easing[i]));
+    __m128  start     = _mm_mul_ps(_mm_loadu_ps(&m_Start[i]), _mm_sub_ps(one, e));
+    __m128  value     = _mm_add_ps(start, _mm_mul_ps(_mm_loadu_ps(&m_End[i]), e));
+    _mm_storeu_ps(&m_Time[i], time);
+    
+    f32 lanes[4];
+    _mm_storeu_ps(lanes, value);
+    for (usize j = 0; j < 4; ++j)
+    {
+      *m_Target[i + j] = lanes[j];
+    }
+  }
+#endif
+  
+  for (; i < n; ++i)
+  {
+    f32 time  = m_Time[i] + dt < m_Duration[i] ? m_Time[i] + dt : m_Duration[i];
+    f32 e     = Internal::Ease(time / m_Duration[i], m_Easing[i]);
+    m_Time[i] = time;
+    *m_Target[i] = m_Start[i] * (1.0f - e) + m_End[i] * e;
+  }
+  
+  // finished tweens have just written their end value.
+  for (i = 0; i < m_Length;)
+  {
+    if (m_Time[i] >= m_Duration[i])
+    {
+      Internal::RemoveTween(*this, i);
+    }
+    else
+    {
+      ++i;
+    }
+  }
+}
+
+void  Tweens::Clear()
+{
+  m_Length = 0;
+}
+
+// if the arena is too small, the tweens stay empty and Add() fails.
+Tweens::Tweens(BumpAllocator& arena, usize capacity)
+{
+  u8* memory  = (u8*)arena.Alloc(capacity * (sizeof(f32*) + 4 * sizeof(f32) + sizeof(u32)));
+  if (!memory)
+  {
+    return;
+  }
+  
+  m_Target = (f32**)memory;
+  m_Start = (f32*)(m_Target + capacity);
+  m_End = m_Start + capacity;
+  m_Time = m_End + capacity;
+  m_Duration = m_Time + capacity;
+  m_Easing = (u32*)(m_Duration + capacity);
+  m_Capacity = capacity;
+}
+
+//-------------------//
+// memory management //
+//-------------------//
+
+void* BumpAllocator::Alloc(usize n)
+{
+  u8* allocation  = &m_Buffer[m_Length];
+  m_Length += n;
+  m_Length = Align(m_Length, MEMORY_ALIGN);
+  
+  u8* actual  = m_Length > m_Capacity ? nullptr : allocation;
+  return (actual);
+}
+
+void  BumpAllocator::Reset()
+{
+  if (m_Buffer)
+  {
+    memset(m_Buffer, 0, m_Capacity);
+  }
+  m_Length = 0;
+}
+
+BumpAllocator::BumpAllocator(u8* buffer, usize capacity)
+  : m_Buffer(buffer),
+  m_Capacity(capacity)
+{
+  if (m_Buffer)
+  {
+    memset(m_Buffer, 0, m_Capacity);
+  }
+}
+
+void* ArrayAllocator::Alloc(usize n)
+{
+  if (m_AllocationsLength >= m_AllocationsCapacity)
+  {
+    return (nullptr);
+  }
+  
+  for (usize i = 0; i < m_AllocationsLength; ++i)
+  {
+    usize offset  = m_Allocations[i].m_Offset + m_Allocations[i].m_Length;
+    offset = Align(offset, MEMORY_ALIGN);
+    
+    if (!RegionFree(offset, n))
+    {
+      continue;
+    }
+    
+    if (offset + n > m_BufferCapacity)
+    {
+      continue;
+    }
+    
+    m_Allocations[m_AllocationsLength].m_Offset = offset;
+    m_Allocations[m_AllocationsLength].m_Length = n;
+    ++m_AllocationsLength;
+    return (&m_Buffer[offset]);
+  }
+  
+  return (nullptr);
+}
+
+void  ArrayAllocator::Free(void* pointer)
+{
+  (void)pointer;
+  
+  // TODO: implement
+}
+
+void* ArrayAllocator::Realloc(void* pointer, usize n)
+{
+  (void)pointer, (void)n;
+  return (nullptr);
+  
+  // TODO: implement
+}
+
+bool  ArrayAllocator::RegionFree(usize offset, usize length)
+{
+  for (usize i = 0; i < m_AllocationsLength; ++i)
+  {
+    bool  noOverlapLeft   = offset + length < m_Allocations[i].m_Offset;
+    bool  noOverlapRight  = offset >= m_Allocations[i].m_Offset + m_Allocations[i].m_Length;
+    bool  noOverlap       = noOverlapLeft || noOverlapRight;
+    
+    if (!noOverlap)
+    {
+      return (false);
+    }
+  }
+  return (true);
+}
+
+void  ArrayAllocator::Reset()
+{
+  memset(m_Buffer, 0, m_BufferCapacity);
+  m_AllocationsLength = 0;
+}
+
+ArrayAllocator::ArrayAllocator(u8* buffer, usize bufferCapacity, Allocation* allocations, usize allocationsCapacity)
+  : m_Buffer(buffer),
+  m_BufferCapacity(bufferCapacity),
+  m_Allocations(allocations),
+  m_AllocationsCapacity(allocationsCapacity)
+{
+  memset(m_Buffer, 0, m_BufferCapacity);
+}
+
+//------//
+// util //
+//------//
+
+void  Error(const char* format, ...)
+{
+  va_list args  {};
+  va_start(args, format);
+  
+  char  msg[512]  = {0};
+  vsnprintf(msg, sizeof(msg), format, args);
+  
+  if (SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, g_Conf.m_ErrorTitle, msg, nullptr))
+  {
+    fprintf(g_Conf.m_Log, "\x1b[1;31merr\x1b[0m: %s\n", msg);
+  }
+  
+  va_end(args);
+}
+
+u64 UnixMicro()
+{
+  timeval timeData  {};
+  gettimeofday(&timeData, nullptr);
+  u64 microTime = (u64)timeData.tv_sec * 1000000 + (u64)timeData.tv_usec;
+  return (microTime);
+}
+
+void  BeginTick()
+{
+  Internal::g_TickStart = UnixMicro();
+  Internal::g_FrameStats = FrameStats{};
+  
+  if (g_Conf.m_TextArena)
+  {
+    g_Conf.m_TextArena->Reset();
+  }
+}
+
+void  EndTick()
+{
+  u64 tickEnd   = UnixMicro();
+  
+  Internal::g_FrameStats.m_Micro = tickEnd - Internal::g_TickStart;
+  Internal::g_FrameHistory[Internal::g_FramesRecorded % FRAME_HISTORY] = Internal::g_FrameStats;
+  ++Internal::g_FramesRecorded;
+  
+  i64 timeLeft  = g_Conf.m_TickMicro - tickEnd + Internal::g_TickStart;
+  timeLeft *= timeLeft > 0;
+  
+  SDL_Delay(timeLeft / 1000);
+}
+
+void  BeginTimer(OUT u64& timer)
+{
+  timer = UnixMicro();
+}
+
+void  EndTimer(u64 timer, const char* name)
+{
+  u64 d = UnixMicro() - timer;
+  fprintf(g_Conf.m_Log, "\x1b[1;33mtimer\x1b[0m: %s: %llu\n", name, (unsigned long long)d);
+}
+
+// age 0 is the frame most recently ended, up to FRAME_HISTORY - 1.
+bool  GetFrameStats(OUT FrameStats& stats, usize age)
+{
+  if (age >= FRAME_HISTORY || age >= Internal::g_FramesRecorded)
+  {
+    return (false);
+  }
+  
+  stats = Internal::g_FrameHistory[(Internal::g_FramesRecorded - 1 - age) % FRAME_HISTORY];
+  return (true);
+}
+
+f32 InterpAngle(f32 a, f32 b, f32 t)
+{
+  f32 interpolated  = (a + ShortestAngle(a, b) * t);
+  return (interpolated);
+}
+
+f32 ShortestAngle(f32 a, f32 b)
+{
+  f32 d         = fmod(b - a, TAU);
+  f32 shortest  = fmod(2.0f * d, TAU) - d;
+  return (shortest);
+}
+
+f32 Degrees(f32 rad)
+{
+  return (rad / PI * 180.0f);
+}
+
+f32 Radians(f32 deg)
+{
+  return (deg / 180.0f * PI);
+}
+
+void* AllocBatch(IN_OUT AllocBatchDesc allocs[], usize nAllocs)
+{
+  usize size  = 0;
+  for (usize i = 0; i < nAllocs; ++i)
+  {
+    size += allocs[i].m_Count * allocs[i].m_Size;
+    size = Align(size, MEMORY_ALIGN);
+  }
+  
+  u8* p = (u8*)malloc(size);
+  if (!p)
+  {
+    return (nullptr);
+  }
+  
+  usize offset  = 0;
+  for (usize i = 0; i < nAllocs; ++i)
+  {
+    *allocs[i].m_Pointer = &p[offset];
+    offset += allocs[i].m_Count * allocs[i].m_Size;
+    offset = Align(offset, MEMORY_ALIGN);
+  }
+  
+  return (p);
+}
+
+void* ReallocBatch(void* p, IN_OUT ReallocBatchDesc reallocs[], usize nReallocs)
+{
+  usize*  oldOffsets  = (usize*)calloc(nReallocs, sizeof(usize));
+  usize*  newOffsets  = (usize*)calloc(nReallocs, sizeof(usize));
+  
+  usize newSize = 0;
+  usize oldSize = 0;
+  for (usize i = 0; i < nReallocs; ++i)
+  {
+    newOffsets[i] = newSize;
+    newSize += reallocs[i].m_NewCount * reallocs[i].m_Size;
+    newSize = Align(newSize, MEMORY_ALIGN);
+    
+    oldOffsets[i] = oldSize;
+    oldSize += reallocs[i].m_OldCount * reallocs[i].m_Size;
+    oldSize = Align(oldSize, MEMORY_ALIGN);
+  }
+  
+  p = realloc(p, newSize);
+  if (!p)
+  {
+    free(oldOffsets);
+    free(newOffsets);
+    return (nullptr);
+  }
+  
+  u8* up  = (u8*)p;
+  for (isize i = nReallocs - 1; i >= 0; --i)
+  {
+    usize newBytes  = reallocs[i].m_NewCount * reallocs[i].m_Size;
+    usize oldBytes  = reallocs[i].m_OldCount * reallocs[i].m_Size;
+    usize bytes     = newBytes < oldBytes ? newBytes : oldBytes;
+    
+    memmove(&up[newOffsets[i]], &up[oldOffsets[i]], bytes);
+    *reallocs[i].m_Pointer = &up[newOffsets[i]];
+  }
+  
+  free(oldOffsets);
+  free(newOffsets);
+  return (p);
+}
+
+u64 Align(u64 addr, u64 align)
+{
+  return (addr + align - addr % align);
+}
+
+u64 HashString(const char* str)
+{
+  // 64-bit FNV-1a.
+  u64 hash  = 0xcbf29ce484222325;
+  for (; *str; ++str)
+  {
+    hash ^= (u8)*str;
+    hash *= 0x100000001b3;
+  }
+  return (hash);
+}
+
+//-------------------------------//
+// platform-dependent procedures //
+//-------------------------------//
+
+namespace Internal
+{
+
+u32 DecodeUTF8(IN_OUT const char*& text)
+{
+  u8  c = *text++;
+  if (c < 0x80)
+  {
+    return (c);
+  }
+  
+  // malformed sequences decode to whatever bits are present.
+  usize n   = c >= 0xf0 ? 3 : c >= 0xe0 ? 2 : 1;
+  u32   cp  = c & 0x3f >> n;
+  for (usize i = 0; i < n && (*text & 0xc0) == 0x80; ++i)
+  {
+    cp = cp << 6 | (*text++ & 0x3f);
+  }
+  
+  return (cp);
+}
+
+#ifdef ZTGL_SDL2_RENDERER
+void  FlushRects()
+{
+  if (!g_BatchRectsLength)
+  {
+    return;
+  }
+  
+  // counting sort by group, stable so each group keeps submission order.
+  usize offsets[MAX_BATCH_RECTS];
+  usize offset  = 0;
+  for (usize i = 0; i < g_RectGroupsLength; ++i)
+  {
+    offsets[i] = offset;
+    offset += g_RectGroups[i].m_Length;
+  }
+  
+  for (usize i = 0; i < g_BatchRectsLength; ++i)
+  {
+    g_SortedRects[offsets[g_BatchRectGroups[i]]++] = g_BatchRects[i];
+  }
+  
+  offset = 0;
+  for (usize i = 0; i < g_RectGroupsLength; ++i)
+  {
+    SDL_SetRenderDrawColor(
+      g_PlatformConf.m_Renderer,
+      DEFAULT_COLORS[g_RectGroups[i].m_Color].r,
+      DEFAULT_COLORS[g_RectGroups[i].m_Color].g,
+      DEFAULT_COLORS[g_RectGroups[i].m_Color].b,
+      DEFAULT_COLORS[g_RectGroups[i].m_Color].a
+    );
+    
+    SDL_RenderFillRects(g_PlatformConf.m_Renderer, &g_SortedRects[offset], g_RectGroups[i].m_Length);
+    offset += g_RectGroups[i].m_Length;
+    ++g_FrameStats.m_ColorChanges;
+    ++g_FrameStats.m_DrawCalls;
+  }
+  
+  g_BatchRectsLength = 0;
+  g_RectGroupsLength = 0;
+}
+
+void  FlushSprites()
+{
+  if (!g_BatchSpritesLength)
+  {
+    return;
+  }
+  
+  if (!g_SpriteIndices[6 * MAX_BATCH_SPRITES - 1])
+  {
+    for (usize i = 0; i < MAX_BATCH_SPRITES; ++i)
+    {
+      g_SpriteIndices[6 * i + 0] = 4 * i + 0;
+      g_SpriteIndices[6 * i + 1] = 4 * i + 1;
+      g_SpriteIndices[6 * i + 2] = 4 * i + 2;
+      g_SpriteIndices[6 * i + 3] = 4 * i + 2;
+      g_SpriteIndices[6 * i + 4] = 4 * i + 3;
+      g_SpriteIndices[6 * i + 5] = 4 * i + 0;
+    }
+  }
+  
+  usize offsets[MAX_BATCH_SPRITES];
+  usize offset  = 0;
+  for (usize i = 0; i < g_SpriteGroupsLength; ++i)
+  {
+    offsets[i] = offset;
+    offset += g_SpriteGroups[i].m_Length;
+  }
+  
+  for (usize i = 0; i < g_BatchSpritesLength; ++i)
+  {
+    usize dst = 4 * offsets[g_BatchSpriteGroups[i]]++;
+    memcpy(&g_SortedSprites[dst], &g_BatchSprites[4 * i], 4 * sizeof(SDL_Vertex));
+  }
+  
+  offset = 0;
+  for (usize i = 0; i < g_SpriteGroupsLength; ++i)
+  {
+    SDL_RenderGeometry(
+      g_PlatformConf.m_Renderer,
+      g_SpriteGroups[i].m_Texture,
+      &g_SortedSprites[4 * offset],
+      4 * g_SpriteGroups[i].m_Length,
+      g_SpriteIndices,
+      6 * g_SpriteGroups[i].m_Length
+    );
+    offset += g_SpriteGroups[i].m_Length;
+    ++g_FrameStats.m_DrawCalls;
+  }
+  
+  g_BatchSpritesLength = 0;
+  g_SpriteGroupsLength = 0;
+}
+
+void  BatchRect(const SDL_Rect& r, Color color)
+{
+  FlushSprites();
+  if (g_BatchRectsLength >= MAX_BATCH_RECTS)
+  {
+    FlushRects();
+  }
+  
+  // look back for a same-colored group, stopping at anything overlapping.
+  usize group = g_RectGroupsLength;
+  for (usize i = g_RectGroupsLength, n = 0; i > 0 && n < BATCH_LOOKBACK; --i, ++n)
+  {
+    if (g_RectGroups[i - 1].m_Color == color)
+    {
+      group = i - 1;
+      break;
+    }
+    
+    if (RectsOverlap(g_RectGroups[i - 1].m_Bounds, r))
+    {
+      break;
+    }
+  }
+  
+  if (group == g_RectGroupsLength)
+  {
+    g_RectGroups[group].m_Bounds = r;
+    g_RectGroups[group].m_Length = 0;
+    g_RectGroups[group].m_Color = color;
+    ++g_RectGroupsLength;
+  }
+  
+  SDL_Rect& bounds  = g_RectGroups[group].m_Bounds;
+  i32       minX    = r.x < bounds.x ? r.x : bounds.x;
+  i32       minY    = r.y < bounds.y ? r.y : bounds.y;
+  i32       maxX    = r.x + r.w > bounds.x + bounds.w ? r.x + r.w : bounds.x + bounds.w;
+  i32       maxY    = r.y + r.h > bounds.y + bounds.h ? r.y + r.h : bounds.y + bounds.h;
+  bounds = SDL_Rect{minX, minY, maxX - minX, maxY - minY};
+  
+  g_BatchRects[g_BatchRectsLength] = r;
+  g_BatchRectGroups[g_BatchRectsLength] = group;
+  ++g_BatchRectsLength;
+  ++g_RectGroups[group].m_Length;
+}
+
+void  FlushBatches()
+{
+  FlushRects();
+  FlushSprites();
+}
+
+void  BatchSprite(const Sprite& sprite)
+{
+  if (!sprite.m_Texture)
+  {
+    return;
+  }
+  
+  FlushRects();
+  if (g_BatchSpritesLength >= MAX_BATCH_SPRITES)
+  {
+    FlushSprites();
+  }
+  
+  // corners go clockwise from the top left, rotated around the center.
+  f32 hw  = 0.5f * sprite.m_W;
+  f32 hh  = 0.5f * sprite.m_H;
+  f32 cx  = sprite.m_X + hw;
+  f32 cy  = sprite.m_Y + hh;
+  f32 c   = 1.0f;
+  f32 s   = 0.0f;
+  if (sprite.m_Angle != 0.0f)
+  {
+    c = cosf(Radians(sprite.m_Angle));
+    s = sinf(Radians(sprite.m_Angle));
+  }
+  
+  f32 dx[4] = {-hw, hw, hw, -hw};
+  f32 dy[4] = {-hh, -hh, hh, hh};
+  SDL_FPoint  corners[4];
+  f32         minX  = cx;
+  f32         minY  = cy;
+  f32         maxX  = cx;
+  f32         maxY  = cy;
+  for (usize i = 0; i < 4; ++i)
+  {
+    corners[i] = SDL_FPoint{cx + dx[i] * c - dy[i] * s, cy + dx[i] * s + dy[i] * c};
+    minX = corners[i].x < minX ? corners[i].x : minX;
+    minY = corners[i].y < minY ? corners[i].y : minY;
+    maxX = corners[i].x > maxX ? corners[i].x : maxX;
+    maxY = corners[i].y > maxY ? corners[i].y : maxY;
+  }
+  
+  SDL_Rect  r {(i32)floorf(minX), (i32)floorf(minY), 0, 0};
+  r.w = (i32)ceilf(maxX) - r.x;
+  r.h = (i32)ceilf(maxY) - r.y;
+  
+  usize group = g_SpriteGroupsLength;
+  for (usize i = g_SpriteGroupsLength, n = 0; i > 0 && n < BATCH_LOOKBACK; --i, ++n)
+  {
+    if (g_SpriteGroups[i - 1].m_Texture == sprite.m_Texture)
+    {
+      group = i - 1;
+      break;
+    }
+    
+    if (RectsOverlap(g_SpriteGroups[i - 1].m_Bounds, r))
+    {
+      break;
+    }
+  }
+  
+  if (group == g_SpriteGroupsLength)
+  {
+    i32 texW  {};
+    i32 texH  {};
+    if (SDL_QueryTexture(sprite.m_Texture, nullptr, nullptr, &texW, &texH) || texW <= 0 || texH <= 0)
+    {
+      return;
+    }
+    
+    g_SpriteGroups[group].m_Bounds = r;
+    g_SpriteGroups[group].m_Texture = sprite.m_Texture;
+    g_SpriteGroups[group].m_TexW = texW;
+    g_SpriteGroups[group].m_TexH = texH;
+    g_SpriteGroups[group].m_Length = 0;
+    ++g_SpriteGroupsLength;
+  }
+  
+  SpriteGroup&  g = g_SpriteGroups[group];
+  SDL_UnionRect(&g.m_Bounds, &r, &g.m_Bounds);
+  
+  SDL_Rect  src = sprite.m_Src;
+  if (!src.w || !src.h)
+  {
+    src = SDL_Rect{0, 0, g.m_TexW, g.m_TexH};
+  }
+  
+  f32 u0  = (f32)src.x / g.m_TexW;
+  f32 v0  = (f32)src.y / g.m_TexH;
+  f32 u1  = (f32)(src.x + src.w) / g.m_TexW;
+  f32 v1  = (f32)(src.y + src.h) / g.m_TexH;
+  
+  SDL_Vertex* v = &g_BatchSprites[4 * g_BatchSpritesLength];
+  v[0] = SDL_Vertex{corners[0], sprite.m_Tint, {u0, v0}};
+  v[1] = SDL_Vertex{corners[1], sprite.m_Tint, {u1, v0}};
+  v[2] = SDL_Vertex{corners[2], sprite.m_Tint, {u1, v1}};
+  v[3] = SDL_Vertex{corners[3], sprite.m_Tint, {u0, v1}};
+  
+  g_BatchSpriteGroups[g_BatchSpritesLength] = group;
+  ++g_BatchSpritesLength;
+  ++g.m_Length;
+}
+
+void  FlushText()
+{
+  if (!g_TextGlyphs)
+  {
+    return;
+  }
+  
+  SDL_RenderGeometry(
+    g_PlatformConf.m_Renderer,
+    g_GlyphAtlas,
+    g_TextVertices,
+    4 * g_TextGlyphs,
+    g_TextIndices,
+    6 * g_TextGlyphs
+  );
+  ++g_FrameStats.m_DrawCalls;
+  
+  g_TextGlyphs = 0;
+}
+
+void  PushGlyphQuad(const Glyph& glyph, f32 x, f32 y, f32 sx, f32 sy, Color color)
+{
+  if (!glyph.m_W || !glyph.m_H)
+  {
+    return;
+  }
+  
+  if (g_TextGlyphs >= MAX_TEXT_GLYPHS)
+  {
+    FlushText();
+  }
+  
+  f32 uv  = 1.0f / GLYPH_ATLAS_SIZE;
+  f32 x1  = x + glyph.m_W * sx;
+  f32 y1  = y + glyph.m_H * sy;
+  f32 u0  = glyph.m_X * uv;
+  f32 v0  = glyph.m_Y * uv;
+  f32 u1  = (glyph.m_X + glyph.m_W) * uv;
+  f32 v1  = (glyph.m_Y + glyph.m_H) * uv;
+  
+  SDL_Vertex* v = &g_TextVertices[4 * g_TextGlyphs];
+  v[0] = SDL_Vertex{{x, y}, DEFAULT_COLORS[color], {u0, v0}};
+  v[1] = SDL_Vertex{{x1, y}, DEFAULT_COLORS[color], {u1, v0}};
+  v[2] = SDL_Vertex{{x1, y1}, DEFAULT_COLORS[color], {u1, v1}};
+  v[3] = SDL_Vertex{{x, y1}, DEFAULT_COLORS[color], {u0, v1}};
+  ++g_TextGlyphs;
+}
+
+void  UploadGlyph(const SDL_Surface& surface, const SDL_Rect& r)
+{
+  SDL_UpdateTexture(g_GlyphAtlas, &r, surface.pixels, surface.pitch);
+}
+
+#else
+// blending runs on 16-bit lanes per channel as (s * a + d * (255 - a) +
+// 255) >> 8, with the source alpha channel taken as 255 so that the
+// destination alpha accumulates coverage. every path uses the same formula
+// so vector and scalar output match exactly.
+void  FillSpan(u32* dst, i32 n, Color color)
+{
+  SDL_Color c   = DEFAULT_COLORS[color];
+  u32       rgba;
+  u8        bytes[4]  = {c.r, c.g, c.b, 255};
+  memcpy(&rgba, bytes, sizeof(rgba));
+  
+  i32 i = 0;
+  if (c.a == 255)
+  {
+    for (; i < n; ++i)
+    {
+      dst[i] = rgba;
+    }
+    return;
+  }
+  
+  u16 ia  = 255 - c.a;
+  u16 sa[4]  =
+  {
+    (u16)(c.r * c.a + 255),
+    (u16)(c.g * c.a + 255),
+    (u16)(c.b * c.a + 255),
+    (u16)(255 * c.a + 255)
+  };
+  
+#if defined(__AVX2__)
+  __m256i zero  = _mm256_setzero_si256();
+  __m256i vIa   = _mm256_set1_epi16(ia);
+  __m256i vSa   = _mm256_setr_epi16(
+    sa[0], sa[1], sa[2], sa[3], sa[0], sa[1], sa[2], sa[3],
+    sa[0], sa[1], sa[2], sa[3], sa[0], sa[1], sa[2], sa[3]
+  );
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256i d   = _mm256_loadu_si256((const __m256i*)&dst[i]);
+    __m256i lo  = _mm256_unpacklo_epi8(d, zero);
+    __m256i hi  = _mm256_unpackhi_epi8(d, zero);
+    lo = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(lo, vIa), vSa), 8);
+    hi = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(hi, vIa), vSa), 8);
+    _mm256_storeu_si256((__m256i*)&dst[i], _mm256_packus_epi16(lo, hi));
+  }
+#elif defined(__SSE2__)
+  __m128i zero  = _mm_setzero_si128();
+  __m128i vIa   = _mm_set1_epi16(ia);
+  __m128i vSa   = _mm_setr_epi16(sa[0], sa[1], sa[2], sa[3], sa[0], sa[1], sa[2], sa[3]);
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128i d   = _mm_loadu_si128((const __m128i*)&dst[i]);
+    __m128i lo  = _mm_unpacklo_epi8(d, zero);
+    __m128i hi  = _mm_unpackhi_epi8(d, zero);
+    lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(lo, vIa), vSa), 8);
+    hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(hi, vIa), vSa), 8);
+    _mm_storeu_si128((__m128i*)&dst[i], _mm_packus_epi16(lo, hi));
+  }
+#endif
+  
+  for (; i < n; ++i)
+  {
+    u8  d[4];
+    memcpy(d, &dst[i], sizeof(d));
+    for (usize j = 0; j < 4; ++j)
+    {
+      d[j] = (sa[j] + d[j] * ia) >> 8;
+    }
+    memcpy(&dst[i], d, sizeof(d));
+  }
+}
+
+// per-pixel alpha is coverage scaled by the color's own alpha.
+void  BlendSpan(u32* dst, const u8* coverage, i32 n, Color color)
+{
+  SDL_Color c = DEFAULT_COLORS[color];
+  u16       s[4]  = {c.r, c.g, c.b, 255};
+  
+  i32 i = 0;
+#if defined(__AVX2__)
+  __m256i zero  = _mm256_setzero_si256();
+  __m256i v255  = _mm256_set1_epi16(255);
+  __m256i vCa   = _mm256_set1_epi16(c.a);
+  __m256i vS    = _mm256_setr_epi16(
+    s[0], s[1], s[2], s[3], s[0], s[1], s[2], s[3],
+    s[0], s[1], s[2], s[3], s[0], s[1], s[2], s[3]
+  );
+  for (; i + 8 <= n; i += 8)
+  {
+    // spread each coverage byte over the four channels of its pixel.
+    __m128i cov = _mm_loadl_epi64((const __m128i*)&coverage[i]);
+    cov = _mm_unpacklo_epi8(cov, cov);
+    __m256i a   = _mm256_setr_m128i(
+      _mm_unpacklo_epi16(cov, cov),
+      _mm_unpackhi_epi16(cov, cov)
+    );
+    __m256i aLo = _mm256_unpacklo_epi8(a, zero);
+    __m256i aHi = _mm256_unpackhi_epi8(a, zero);
+    aLo = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(aLo, vCa), v255), 8);
+    aHi = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(aHi, vCa), v255), 8);
+    
+    __m256i d   = _mm256_loadu_si256((const __m256i*)&dst[i]);
+    __m256i lo  = _mm256_unpacklo_epi8(d, zero);
+    __m256i hi  = _mm256_unpackhi_epi8(d, zero);
+    lo = _mm256_add_epi16(_mm256_mullo_epi16(vS, aLo), _mm256_mullo_epi16(lo, _mm256_sub_epi16(v255, aLo)));
+    hi = _mm256_add_epi16(_mm256_mullo_epi16(vS, aHi), _mm256_mullo_epi16(hi, _mm256_sub_epi16(v255, aHi)));
+    lo = _mm256_srli_epi16(_mm256_add_epi16(lo, v255), 8);
+    hi = _mm256_srli_epi16(_mm256_add_epi16(hi, v255), 8);
+    _mm256_storeu_si256((__m256i*)&dst[i], _mm256_packus_epi16(lo, hi));
+  }
+#elif defined(__SSE2__)
+  __m128i zero  = _mm_setzero_si128();
+  __m128i v255  = _mm_set1_epi16(255);
+  __m128i vCa   = _mm_set1_epi16(c.a);
+  __m128i vS    = _mm_setr_epi16(s[0], s[1], s[2], s[3], s[0], s[1], s[2], s[3]);
+  for (; i + 4 <= n; i += 4)
+  {
+    // spread each coverage byte over the four channels of its pixel.
+    i32     bits;
+    memcpy(&bits, &coverage[i], sizeof(bits));
+    __m128i a   = _mm_cvtsi32_si128(bits);
+    a = _mm_unpacklo_epi8(a, a);
+    a = _mm_unpacklo_epi16(a, a);
+    __m128i aLo = _mm_unpacklo_epi8(a, zero);
+    __m128i aHi = _mm_unpackhi_epi8(a, zero);
+    aLo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(aLo, vCa), v255), 8);
+    aHi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(aHi, vCa), v255), 8);
+    
+    __m128i d   = _mm_loadu_si128((const __m128i*)&dst[i]);
+    __m128i lo  = _mm_unpacklo_epi8(d, zero);
+    __m128i hi  = _mm_unpackhi_epi8(d, zero);
+    lo = _mm_add_epi16(_mm_mullo_epi16(vS, aLo), _mm_mullo_epi16(lo, _mm_sub_epi16(v255, aLo)));
+    hi = _mm_add_epi16(_mm_mullo_epi16(vS, aHi), _mm_mullo_epi16(hi, _mm_sub_epi16(v255, aHi)));
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, v255), 8);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, v255), 8);
+    _mm_storeu_si128((__m128i*)&dst[i], _mm_packus_epi16(lo, hi));
+  }
+#endif
+  
+  for (; i < n; ++i)
+  {
+    u16 a = (coverage[i] * c.a + 255) >> 8;
+    u8  d[4];
+    memcpy(d, &dst[i], sizeof(d));
+    for (usize j = 0; j < 4; ++j)
+    {
+      d[j] = (s[j] * a + d[j] * (255 - a) + 255) >> 8;
+    }
+    memcpy(&dst[i], d, sizeof(d));
+  }
+}
+
+void  RasterizeBand(i32 y0, i32 y1)
+{
+  u32*  pixels  = g_PlatformConf.m_Pixels;
+  i32   pitch   = g_PlatformConf.m_Pitch;
+  
+  for (usize i = 0; i < g_SoftCmdsLength; ++i)
+  {
+    const SoftCmd&  cmd   = g_SoftCmds[i];
+    i32             top   = cmd.m_Rect.y > y0 ? cmd.m_Rect.y : y0;
+    i32             bot   = cmd.m_Rect.y + cmd.m_Rect.h < y1 ? cmd.m_Rect.y + cmd.m_Rect.h : y1;
+    
+    for (i32 y = top; y < bot; ++y)
+    {
+      u32*  row = &pixels[(usize)y * pitch + cmd.m_Rect.x];
+      if (cmd.m_Type == SOFT_RECT)
+      {
+        FillSpan(row, cmd.m_Rect.w, cmd.m_Color);
+      }
+      else
+      {
+        const u8* coverage  = &g_CoverageAtlas[(usize)(y + cmd.m_SrcY) * GLYPH_ATLAS_SIZE + cmd.m_Rect.x + cmd.m_SrcX];
+        BlendSpan(row, coverage, cmd.m_Rect.w, cmd.m_Color);
+      }
+    }
+  }
+}
+
+i32 RasterWorkerMain(void* arg)
+{
+  RasterWorker& worker  = *(RasterWorker*)arg;
+  for (;;)
+  {
+    SDL_SemWait(worker.m_Start);
+    if (g_RasterQuit)
+    {
+      return (0);
+    }
+    
+    RasterizeBand(worker.m_Y0, worker.m_Y1);
+    SDL_SemPost(g_RasterDone);
+  }
+}
+
+void  StopRasterWorkers()
+{
+  g_RasterQuit = true;
+  for (usize i = 0; i < g_RasterWorkersLength; ++i)
+  {
+    SDL_SemPost(g_RasterWorkers[i].m_Start);
+    SDL_WaitThread(g_RasterWorkers[i].m_Thread, nullptr);
+    SDL_DestroySemaphore(g_RasterWorkers[i].m_Start);
+    g_RasterWorkers[i] = RasterWorker{};
+  }
+  
+  g_RasterWorkersLength = 0;
+  g_RasterQuit = false;
+}
+
+bool  StartRasterWorkers(usize n)
+{
+  if (!g_RasterDone)
+  {
+    g_RasterDone = SDL_CreateSemaphore(0);
+    if (!g_RasterDone)
+    {
+      return (false);
+    }
+  }
+  
+  for (; g_RasterWorkersLength < n; ++g_RasterWorkersLength)
+  {
+    RasterWorker& worker  = g_RasterWorkers[g_RasterWorkersLength];
+    worker.m_Start = SDL_CreateSemaphore(0);
+    if (!worker.m_Start)
+    {
+      return (false);
+    }
+    
+    worker.m_Thread = SDL_CreateThread(RasterWorkerMain, "ztgl raster", &worker);
+    if (!worker.m_Thread)
+    {
+      SDL_DestroySemaphore(worker.m_Start);
+      worker.m_Start = nullptr;
+      return (false);
+    }
+  }
+  
+  return (true);
+}
+
+// all recorded commands are rendered, split into horizontal bands that
+// the calling thread and the worker threads fill in parallel.
+void  FlushText()
+{
+  if (!g_SoftCmdsLength || !g_PlatformConf.m_Pixels)
+  {
+    g_SoftCmdsLength = 0;
+    return;
+  }
+  
+  ++g_FrameStats.m_DrawCalls;
+  i32   height    = g_PlatformConf.m_Height;
+  usize nThreads  = g_PlatformConf.m_Threads;
+  nThreads = nThreads < 1 ? 1 : nThreads;
+  nThreads = nThreads > MAX_RASTER_THREADS ? MAX_RASTER_THREADS : nThreads;
+  if (nThreads > 1 && !StartRasterWorkers(nThreads - 1))
+  {
+    nThreads = g_RasterWorkersLength + 1;
+  }
+  
+  i32 band  = (height + nThreads - 1) / nThreads;
+  for (usize i = 1; i < nThreads; ++i)
+  {
+    g_RasterWorkers[i - 1].m_Y0 = i * band < (usize)height ? i * band : height;
+    g_RasterWorkers[i - 1].m_Y1 = (i + 1) * band < (usize)height ? (i + 1) * band : height;
+    SDL_SemPost(g_RasterWorkers[i - 1].m_Start);
+  }
+  
+  RasterizeBand(0, band < height ? band : height);
+  for (usize i = 1; i < nThreads; ++i)
+  {
+    SDL_SemWait(g_RasterDone);
+  }
+  
+  g_SoftCmdsLength = 0;
+}
+
+void  RecordSoftCmd(SDL_Rect r, const SDL_Rect& clip, i32 srcX, i32 srcY, SoftType type, Color color)
+{
+  if (!ClipRect(r, clip))
+  {
+    return;
+  }
+  
+  if (g_SoftClipped && !ClipRect(r, g_SoftClip))
+  {
+    return;
+  }
+  
+  if (g_SoftCmdsLength >= MAX_SOFT_CMDS)
+  {
+    FlushText();
+  }
+  
+  g_SoftCmds[g_SoftCmdsLength].m_Rect   = r;
+  g_SoftCmds[g_SoftCmdsLength].m_SrcX   = srcX;
+  g_SoftCmds[g_SoftCmdsLength].m_SrcY   = srcY;
+  g_SoftCmds[g_SoftCmdsLength].m_Type   = type;
+  g_SoftCmds[g_SoftCmdsLength].m_Color  = color;
+  ++g_SoftCmdsLength;
+}
+
+void  UploadGlyph(const SDL_Surface& surface, const SDL_Rect& r)
+{
+  for (i32 y = 0; y < r.h; ++y)
+  {
+    const u32*  src = (const u32*)((const u8*)surface.pixels + (usize)y * surface.pitch);
+    u8*         dst = &g_CoverageAtlas[(usize)(r.y + y) * GLYPH_ATLAS_SIZE + r.x];
+    for (i32 x = 0; x < r.w; ++x)
+    {
+      dst[x] = src[x] >> 24;
+    }
+  }
+}
+#endif
+
+void  ResetGlyphAtlas()
+{
+  // pending quads reference the old atlas contents.
+  FlushText();
+  
+  memset(g_Glyphs, 0, sizeof(g_Glyphs));
+  g_GlyphsLength = 0;
+  g_ShelfX = 0;
+  g_ShelfY = 0;
+  g_ShelfH = 0;
+}
+
+usize GlyphSlot(TTF_Font* font, u32 codepoint)
+{
+  usize slot  = (uintptr_t)font >> 4 ^ codepoint * 2654435761u;
+  return (slot & (MAX_ATLAS_GLYPHS - 1));
+}
+
+// returns the glyph if present, else the empty slot it would go in.
+const Glyph*  FindGlyph(TTF_Font* font, u32 codepoint, OUT usize& slot)
+{
+  slot = GlyphSlot(font, codepoint);
+  while (g_Glyphs[slot].m_Font)
+  {
+    if (g_Glyphs[slot].m_Font == font && g_Glyphs[slot].m_Codepoint == codepoint)
+    {
+      return (&g_Glyphs[slot]);
+    }
+    slot = (slot + 1) & (MAX_ATLAS_GLYPHS - 1);
+  }
+  
+  return (nullptr);
+}
+
+// glyphs are rasterized once in white and tinted when drawn. glyphs
+// without any pixels (e.g. space) produce no surface, only an advance.
+bool  RasterizeGlyph(TTF_Font* font, u32 codepoint, OUT SDL_Surface*& surface, OUT i32& advance)
+{
+  surface = nullptr;
+  if (TTF_GlyphMetrics32(font, codepoint, nullptr, nullptr, nullptr, nullptr, &advance))
+  {
+    return (false);
+  }
+  
+  surface = TTF_RenderGlyph32_Blended(font, codepoint, SDL_Color{255, 255, 255, 255});
+  if (surface && surface->format->format != SDL_PIXELFORMAT_ARGB8888)
+  {
+    SDL_Surface*  converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(surface);
+    surface = converted;
+  }
+  
+  return (true);
+}
+
+// takes ownership of the surface.
+const Glyph*  InsertGlyph(TTF_Font* font, u32 codepoint, SDL_Surface* surface, i32 advance)
+{
+  usize         slot  {};
+  const Glyph*  found = FindGlyph(font, codepoint, slot);
+  
+  i32 w = surface ? surface->w : 0;
+  i32 h = surface ? surface->h : 0;
+  if (found || w > GLYPH_ATLAS_SIZE || h > GLYPH_ATLAS_SIZE)
+  {
+    SDL_FreeSurface(surface);
+    return (found);
+  }
+  
+  if (g_ShelfX + w > GLYPH_ATLAS_SIZE)
+  {
+    g_ShelfX = 0;
+    g_ShelfY += g_ShelfH;
+    g_ShelfH = 0;
+  }
+  
+  // on overflow start over, keeping the table at most half full.
+  if (g_ShelfY + h > GLYPH_ATLAS_SIZE || g_GlyphsLength >= MAX_ATLAS_GLYPHS / 2)
+  {
+    ResetGlyphAtlas();
+    slot = GlyphSlot(font, codepoint);
+  }
+  
+  if (surface)
+  {
+    UploadGlyph(*surface, SDL_Rect{g_ShelfX, g_ShelfY, w, h});
+    SDL_FreeSurface(surface);
+  }
+  
+  g_Glyphs[slot].m_Font       = font;
+  g_Glyphs[slot].m_Codepoint  = codepoint;
+  g_Glyphs[slot].m_X          = g_ShelfX;
+  g_Glyphs[slot].m_Y          = g_ShelfY;
+  g_Glyphs[slot].m_W          = w;
+  g_Glyphs[slot].m_H          = h;
+  g_Glyphs[slot].m_Advance    = advance;
+  ++g_GlyphsLength;
+  
+  g_ShelfX += w;
+  g_ShelfH = h > g_ShelfH ? h : g_ShelfH;
+  
+  return (&g_Glyphs[slot]);
+}
+
+const Glyph*  AtlasGlyph(TTF_Font* font, u32 codepoint)
+{
+  usize         slot  {};
+  const Glyph*  found = FindGlyph(font, codepoint, slot);
+  if (found)
+  {
+    return (found);
+  }
+  
+  SDL_Surface*  surface {};
+  i32           advance {};
+  if (!RasterizeGlyph(font, codepoint, surface, advance))
+  {
+    return (nullptr);
+  }
+  ++g_FrameStats.m_Rasterizations;
+  
+  return (InsertGlyph(font, codepoint, surface, advance));
+}
+
+usize UploadGlyphResults(usize max);
+
+// glyphs are rasterized on a worker thread, then handed back through a
+// lock-free single producer / single consumer ring for the main thread
+// to upload. jobs travel the other way through a second ring. while the
+// job ring is full, results are uploaded here so that the worker can go
+// on. returns false if it cannot, i.e. both rings are full and the results
+// cannot be uploaded.
+bool  PushGlyphJob(const GlyphJob& job)
 {
-  fseek(file, 0, SEEK_SET);
-  
-  for (usize line = 0; !feof(file) && !ferror(file); ++line)
+  u32 head  = SDL_AtomicGet(&g_GlyphJobsHead);
+  while (head - (u32)SDL_AtomicGet(&g_GlyphJobsTail) >= MAX_GLYPH_JOBS)
   {
-    i32 c {};
-    while (c = fgetc(file), c != EOF && isspace(c))
-    {
-    }
-    
-    if (c == '#')
-    {
-      while (c = fgetc(file), c != EOF && c != '\n')
-      {
-      }
-    }
-    
-    if (c == '\n' || feof(file))
+    if (UploadGlyphResults(SIZE_MAX))
     {
       continue;
     }
     
-    fseek(file, -1, SEEK_CUR);
-    char  keyBuffer[MAX_OPTION_KEY] = {0};
-    if (fscanf(file, OPTION_SCAN, keyBuffer, data) != 2)
+    u32 results = SDL_AtomicGet(&g_GlyphResultsHead) - (u32)SDL_AtomicGet(&g_GlyphResultsTail);
+    if (results >= MAX_GLYPH_RESULTS)
     {
-      return (INVALID_FORMAT);
+      return (false);
     }
     
-    if (!strcmp(data, "NONE"))
+    SDL_Delay(1);
+  }
+  
+  SDL_AtomicAdd(&g_GlyphsInFlight, job.m_Last - job.m_First + 1);
+  g_GlyphJobs[head % MAX_GLYPH_JOBS] = job;
+  SDL_MemoryBarrierRelease();
+  SDL_AtomicSet(&g_GlyphJobsHead, head + 1);
+  SDL_SemPost(g_GlyphJobsReady);
+  return (true);
+}
+
+i32 GlyphWorkerMain(void* arg)
+{
+  (void)arg;
+  
+  for (;;)
+  {
+    SDL_SemWait(g_GlyphJobsReady);
+    if (SDL_AtomicGet(&g_GlyphWorkerQuit))
     {
-      data[0] = 0;
+      return (0);
     }
     
-    if (!strcmp(keyBuffer, key))
+    u32 tail  = SDL_AtomicGet(&g_GlyphJobsTail);
+    SDL_MemoryBarrierAcquire();
+    GlyphJob  job = g_GlyphJobs[tail % MAX_GLYPH_JOBS];
+    SDL_AtomicSet(&g_GlyphJobsTail, tail + 1);
+    
+    for (u32 cp = job.m_First; cp <= job.m_Last; ++cp)
     {
-      return (OK);
+      GlyphResult result  {job.m_Font, nullptr, cp, 0, false};
+      result.m_Valid = RasterizeGlyph(job.m_WorkerFont, cp, result.m_Surface, result.m_Advance);
+      
+      u32 head  = SDL_AtomicGet(&g_GlyphResultsHead);
+      while (head - (u32)SDL_AtomicGet(&g_GlyphResultsTail) >= MAX_GLYPH_RESULTS)
+      {
+        if (SDL_AtomicGet(&g_GlyphWorkerQuit))
+        {
+          SDL_FreeSurface(result.m_Surface);
+          return (0);
+        }
+        SDL_Delay(1);
+      }
+      
+      g_GlyphResults[head % MAX_GLYPH_RESULTS] = result;
+      SDL_MemoryBarrierRelease();
+      SDL_AtomicSet(&g_GlyphResultsHead, head + 1);
     }
   }
-  
-  return (NOT_FOUND);
 }
 
-ErrorCode OptionKeycode(OUT SDL_Keycode& data, FILE* file, const char* key)
+bool  StartGlyphWorker()
 {
-  char      buffer[MAX_OPTION_VALUE]  = {0};
-  ErrorCode err = OptionRaw(buffer, file, key);
-  if (err)
+  if (g_GlyphWorker)
   {
-    return (err);
+    return (true);
   }
   
-  data = SDL_GetKeyFromName(buffer);
-  if (data == SDLK_UNKNOWN)
+  g_GlyphJobsReady = SDL_CreateSemaphore(0);
+  if (!g_GlyphJobsReady)
   {
-    return (INVALID_CONVERSION);
+    return (false);
   }
   
-  return (OK);
+  SDL_AtomicSet(&g_GlyphWorkerQuit, 0);
+  g_GlyphWorker = SDL_CreateThread(GlyphWorkerMain, "ztgl glyphs", nullptr);
+  if (!g_GlyphWorker)
+  {
+    SDL_DestroySemaphore(g_GlyphJobsReady);
+    g_GlyphJobsReady = nullptr;
+    return (false);
+  }
+  
+  return (true);
 }
 
-ErrorCode OptionFloat(OUT f32& data, FILE* file, const char* key)
+bool  CreateGlyphAtlas();
+
+usize UploadGlyphResults(usize max)
 {
-  char      buffer[MAX_OPTION_VALUE]  = {0};
-  ErrorCode err = OptionRaw(buffer, file, key);
-  if (err)
+#ifdef ZTGL_SDL2_RENDERER
+  if (SDL_AtomicGet(&g_GlyphResultsHead) == SDL_AtomicGet(&g_GlyphResultsTail) || !CreateGlyphAtlas())
   {
-    return (err);
+    return (0);
   }
+#endif
   
-  errno = 0;
-  data = strtof(buffer, nullptr);
-  if (errno)
+  usize n = 0;
+  for (; n < max; ++n)
   {
-    return (INVALID_CONVERSION);
+    u32 tail  = SDL_AtomicGet(&g_GlyphResultsTail);
+    if (tail == (u32)SDL_AtomicGet(&g_GlyphResultsHead))
+    {
+      break;
+    }
+    
+    SDL_MemoryBarrierAcquire();
+    GlyphResult result  = g_GlyphResults[tail % MAX_GLYPH_RESULTS];
+    SDL_AtomicSet(&g_GlyphResultsTail, tail + 1);
+    SDL_AtomicAdd(&g_GlyphsInFlight, -1);
+    
+    if (result.m_Valid)
+    {
+      InsertGlyph(result.m_Font, result.m_Codepoint, result.m_Surface, result.m_Advance);
+    }
   }
   
-  return (OK);
+  return (n);
 }
 
-ErrorCode OptionInt(OUT i64& data, FILE* file, const char* key)
+void  StopGlyphWorker()
 {
-  char      buffer[MAX_OPTION_VALUE]  = {0};
-  ErrorCode err = OptionRaw(buffer, file, key);
-  if (err)
+  if (!g_GlyphWorker)
   {
-    return (err);
+    return;
   }
   
-  errno = 0;
-  data = (i64)strtoll(buffer, nullptr, 0);
-  if (errno)
+  SDL_AtomicSet(&g_GlyphWorkerQuit, 1);
+  SDL_SemPost(g_GlyphJobsReady);
+  SDL_WaitThread(g_GlyphWorker, nullptr);
+  SDL_DestroySemaphore(g_GlyphJobsReady);
+  g_GlyphWorker = nullptr;
+  g_GlyphJobsReady = nullptr;
+  
+  // whatever was not uploaded yet is dropped.
+  while (SDL_AtomicGet(&g_GlyphResultsTail) != SDL_AtomicGet(&g_GlyphResultsHead))
   {
-    return (INVALID_CONVERSION);
+    u32 tail  = SDL_AtomicGet(&g_GlyphResultsTail);
+    SDL_FreeSurface(g_GlyphResults[tail % MAX_GLYPH_RESULTS].m_Surface);
+    SDL_AtomicSet(&g_GlyphResultsTail, tail + 1);
   }
   
-  return (OK);
+  SDL_AtomicSet(&g_GlyphJobsHead, 0);
+  SDL_AtomicSet(&g_GlyphJobsTail, 0);
+  SDL_AtomicSet(&g_GlyphResultsHead, 0);
+  SDL_AtomicSet(&g_GlyphResultsTail, 0);
+  SDL_AtomicSet(&g_GlyphsInFlight, 0);
 }
 
-ErrorCode OptionBool(OUT bool& data, FILE* file, const char* key)
+#ifdef ZTGL_SDL2_RENDERER
+bool  CreateGlyphAtlas()
 {
-  char      buffer[MAX_OPTION_VALUE]  = {0};
-  ErrorCode err = OptionRaw(buffer, file, key);
-  if (err)
+  if (g_GlyphAtlas && g_GlyphAtlasRenderer == g_PlatformConf.m_Renderer)
   {
-    return (err);
+    return (true);
   }
   
-  if (!strcmp(buffer, "true"))
+  // textures belong to a single renderer, so the atlas is rebuilt on change.
+  if (g_GlyphAtlas)
   {
-    data = true;
-    return (OK);
+    SDL_DestroyTexture(g_GlyphAtlas);
   }
-  else if (!strcmp(buffer, "false"))
+  
+  g_GlyphAtlas = SDL_CreateTexture(
+    g_PlatformConf.m_Renderer,
+    SDL_PIXELFORMAT_ARGB8888,
+    SDL_TEXTUREACCESS_STATIC,
+    GLYPH_ATLAS_SIZE,
+    GLYPH_ATLAS_SIZE
+  );
+  
+  if (!g_GlyphAtlas)
   {
-    data = false;
-    return (OK);
+    g_GlyphAtlasRenderer = nullptr;
+    return (false);
   }
-  else
+  ++g_FrameStats.m_TexturesCreated;
+  
+  SDL_SetTextureBlendMode(g_GlyphAtlas, SDL_BLENDMODE_BLEND);
+  g_GlyphAtlasRenderer = g_PlatformConf.m_Renderer;
+  ResetGlyphAtlas();
+  
+  for (usize i = 0; i < MAX_TEXT_GLYPHS; ++i)
   {
-    return (INVALID_CONVERSION);
+    g_TextIndices[6 * i + 0] = 4 * i + 0;
+    g_TextIndices[6 * i + 1] = 4 * i + 1;
+    g_TextIndices[6 * i + 2] = 4 * i + 2;
+    g_TextIndices[6 * i + 3] = 4 * i + 2;
+    g_TextIndices[6 * i + 4] = 4 * i + 3;
+    g_TextIndices[6 * i + 5] = 4 * i + 0;
   }
+  
+  return (true);
 }
 
-//----//
-// ui //
-//----//
-
-TFData::TFData(char buffer[], usize capacity)
-  : m_Buffer(buffer),
-  m_Capacity(capacity)
+usize CachedTextSlot(TTF_Font* font, u64 hash, Color color)
 {
-  memset(buffer, 0, capacity);
+  usize slot  = hash ^ (uintptr_t)font >> 4 ^ (u64)color * 0x9e3779b97f4a7c15;
+  return (slot & (2 * MAX_CACHED_TEXTS - 1));
 }
 
-UIPanel::UIPanel(UIElem elems[], usize elemsCapacity, TTF_Font* font, const SDL_Window* window)
-  : m_Elems(elems),
-  m_ElemsCapacity(elemsCapacity),
-  m_Font(font),
-  m_Window(window)
+void  UnlinkCachedText(u16 index)
 {
+  CachedText& entry = g_CachedTexts[index];
+  
+  if (entry.m_Prev != NO_TEXT)
+  {
+    g_CachedTexts[entry.m_Prev].m_Next = entry.m_Next;
+  }
+  else
+  {
+    g_CachedTextHead = entry.m_Next;
+  }
+  
+  if (entry.m_Next != NO_TEXT)
+  {
+    g_CachedTexts[entry.m_Next].m_Prev = entry.m_Prev;
+  }
+  else
+  {
+    g_CachedTextTail = entry.m_Prev;
+  }
 }
 
-void  UIPanel::Render()
+void  LinkCachedText(u16 index)
 {
-  if (!m_ElemsLength)
+  g_CachedTexts[index].m_Prev = NO_TEXT;
+  g_CachedTexts[index].m_Next = g_CachedTextHead;
+  
+  if (g_CachedTextHead != NO_TEXT)
   {
-    return;
+    g_CachedTexts[g_CachedTextHead].m_Prev = index;
   }
-  
-  // find render boundaries to draw panel
-  i32 minX  = INT32_MAX;
-  i32 minY  = INT32_MAX;
-  i32 maxX  = INT32_MIN;
-  i32 maxY  = INT32_MIN;
-  for (usize i = 0; i < m_ElemsLength; ++i)
+  else
   {
-    i32 x = m_Elems[i].m_Any.m_X;
-    i32 y = m_Elems[i].m_Any.m_Y;
-    i32 w = m_Elems[i].m_Any.m_W;
-    i32 h = m_Elems[i].m_Any.m_H;
-    
-    minX  = x < minX ? x : minX;
-    minY  = y < minY ? y : minY;
-    maxX  = x + w > maxX ? x + w : maxX;
-    maxY  = y + h > maxY ? y + h : maxY;
+    g_CachedTextTail = index;
   }
   
-  i32 pad = g_Conf.m_UIPad;
+  g_CachedTextHead = index;
+}
+
+void  EvictCachedText(u16 index)
+{
+  CachedText& entry = g_CachedTexts[index];
+  usize       mask  = 2 * MAX_CACHED_TEXTS - 1;
   
-  // draw panel
-  g_Conf.m_RenderRect(minX - pad, minY - pad, maxX - minX + 2 * pad, maxY - minY + 2 * pad, PANEL_COLOR);
+  // backward shift deletion keeps linear probe chains intact.
+  usize slot  = CachedTextSlot(entry.m_Font, entry.m_Hash, entry.m_Color);
+  while (g_CachedTextTable[slot] != index + 1)
+  {
+    slot = (slot + 1) & mask;
+  }
   
-  // draw UI elements
-  SDL_Point m = MousePos(m_Window);
-  for (usize i = 0; i < m_ElemsLength; ++i)
+  for (usize next = (slot + 1) & mask; g_CachedTextTable[next]; next = (next + 1) & mask)
   {
-    Internal::UIType  type  = (Internal::UIType)m_Elems[i].m_Any.m_Type;
-    i32               x     = m_Elems[i].m_Any.m_X;
-    i32               y     = m_Elems[i].m_Any.m_Y;
-    i32               w     = m_Elems[i].m_Any.m_W;
-    i32               h     = m_Elems[i].m_Any.m_H;
-    
-    if (m_Elems[i].m_Any.m_Flags & Internal::INACTIVE)
-    {
-      g_Conf.m_RenderRect(x, y, w, h, INACTIVE_COLOR);
-      continue;
-    }
-    
-    if (type == Internal::LABEL)
-    {
-      g_Conf.m_RenderText(x, y, w, h, m_Elems[i].m_Label.m_Text, LABEL_TEXT_COLOR);
-    }
-    else if (type == Internal::BUTTON || type == Internal::BUTTON)
-    {
-      Color buttonColor = BUTTON_COLOR;
-      Color textColor   = BUTTON_TEXT_COLOR;
-      if (m.x >= x && m.y >= y && m.x < x + w && m.y < y + h)
-      {
-        if (MouseDown(SDL_BUTTON_LEFT))
-        {
-          buttonColor = BUTTON_PRESS_COLOR;
-          textColor   = BUTTON_TEXT_PRESS_COLOR;
-        }
-        else
-        {
-          buttonColor = BUTTON_HOVER_COLOR;
-          textColor   = BUTTON_TEXT_HOVER_COLOR;
-        }
-      }
-      
-      g_Conf.m_RenderRect(x, y, w, h, buttonColor);
-      g_Conf.m_RenderText(x + pad, y + pad, w - 2 * pad, h - 2 * pad, m_Elems[i].m_Button.m_Text, textColor);
-    }
-    else if (type == Internal::SLIDER)
+    const CachedText& moved = g_CachedTexts[g_CachedTextTable[next] - 1];
+    usize             home  = CachedTextSlot(moved.m_Font, moved.m_Hash, moved.m_Color);
+    if (((next - home) & mask) >= ((next - slot) & mask))
     {
-      Color sliderColor = SLIDER_COLOR;
-      Color textColor   = SLIDER_TEXT_COLOR;
-      Color barColor    = SLIDER_BAR_COLOR;
-      if (m.x >= x && m.y >= y && m.x < x + w && m.y < y + h)
-      {
-        if (MouseDown(SDL_BUTTON_LEFT))
-        {
-          sliderColor = SLIDER_PRESS_COLOR;
-          textColor   = SLIDER_TEXT_PRESS_COLOR;
-          barColor    = SLIDER_BAR_PRESS_COLOR;
-        }
-        else
-        {
-          sliderColor = SLIDER_HOVER_COLOR;
-          textColor   = SLIDER_TEXT_HOVER_COLOR;
-          barColor    = SLIDER_BAR_HOVER_COLOR;
-        }
-      }
-      
-      g_Conf.m_RenderRect(x, y, w, h, sliderColor);
-      g_Conf.m_RenderRect(x, y, m_Elems[i].m_Slider.m_Value * w, h, barColor);
-      g_Conf.m_RenderText(x + pad, y + pad, w - 2 * pad, h - 2 * pad, m_Elems[i].m_Slider.m_Text, textColor);
+      g_CachedTextTable[slot] = g_CachedTextTable[next];
+      slot = next;
     }
-    else // text field
+  }
+  g_CachedTextTable[slot] = 0;
+  
+  UnlinkCachedText(index);
+  SDL_DestroyTexture(entry.m_Texture);
+  g_TextCacheStats.m_Bytes -= entry.m_Bytes;
+  --g_TextCacheStats.m_Entries;
+  ++g_TextCacheStats.m_Evictions;
+  
+  entry = CachedText{};
+  g_CachedTextFree[g_CachedTextFreeLength++] = index;
+}
+
+void  ClearTextCache()
+{
+  while (g_CachedTextTail != NO_TEXT)
+  {
+    EvictCachedText(g_CachedTextTail);
+  }
+  
+  g_CachedTextFreeLength = 0;
+  for (usize i = 0; i < MAX_CACHED_TEXTS; ++i)
+  {
+    g_CachedTextFree[g_CachedTextFreeLength++] = MAX_CACHED_TEXTS - 1 - i;
+  }
+}
+
+// returns nullptr when the string should not or could not be cached.
+SDL_Texture*  FindCachedText(TTF_Font* font, const char* text, Color color)
+{
+  if (g_TextCacheRenderer != g_PlatformConf.m_Renderer)
+  {
+    ClearTextCache();
+    g_TextCacheRenderer = g_PlatformConf.m_Renderer;
+  }
+  
+  usize length  = strlen(text);
+  if (length >= CACHED_TEXT_LENGTH)
+  {
+    return (nullptr);
+  }
+  
+  u64   hash  = HashString(text);
+  usize mask  = 2 * MAX_CACHED_TEXTS - 1;
+  usize slot  = CachedTextSlot(font, hash, color);
+  for (; g_CachedTextTable[slot]; slot = (slot + 1) & mask)
+  {
+    u16         index = g_CachedTextTable[slot] - 1;
+    CachedText& entry = g_CachedTexts[index];
+    if (entry.m_Font == font && entry.m_Hash == hash && entry.m_Color == color && !strcmp(entry.m_Text, text))
     {
-      Color textFieldColor        = TEXT_FIELD_COLOR;
-      Color textFieldTextColor    = TEXT_FIELD_TEXT_COLOR;
-      Color textFieldBarColor     = TEXT_FIELD_TEXT_COLOR;
-      Color textFieldPromptColor  = TEXT_FIELD_PROMPT_COLOR;
-      if (m.x >= x && m.y >= y && m.x < x + w && m.y < y + h)
-      {
-        if (MouseDown(SDL_BUTTON_LEFT))
-        {
-          textFieldColor        = TEXT_FIELD_PRESS_COLOR;
-          textFieldTextColor    = TEXT_FIELD_TEXT_COLOR;
-          textFieldBarColor     = TEXT_FIELD_BAR_COLOR;
-          textFieldPromptColor  = TEXT_FIELD_PROMPT_COLOR;
-        }
-        else
-        {
-          textFieldColor        = TEXT_FIELD_HOVER_COLOR;
-          textFieldTextColor    = TEXT_FIELD_TEXT_HOVER_COLOR;
-          textFieldBarColor     = TEXT_FIELD_BAR_HOVER_COLOR;
-          textFieldPromptColor  = TEXT_FIELD_PROMPT_HOVER_COLOR;
-        }
-      }
-      
-      g_Conf.m_RenderRect(x, y, w, h, textFieldColor);
-      
-      const TFData& data        = *m_Elems[i].m_TextField.m_TFData;
-      i32           charWidth   = (w - 2 * pad) / m_Elems[i].m_TextField.m_NDraw;
-      i32           charHeight  = h - 2 * pad;
-      
-      const char* text        = data.m_Length ? data.m_Buffer : m_Elems[i].m_TextField.m_Text;
-      u32         textFirst   = data.m_Length ? data.m_First : 0;
-      u32         textLength  = data.m_Length ? data.m_Length : strlen(text);
-      Color       textColor   = data.m_Length ? textFieldTextColor : textFieldPromptColor;
-      
-      i32 dx  = 0;
-      for (u32 j = textFirst; j < textLength; ++j)
-      {
-        if (dx >= w - 2 * pad)
-        {
-          break;
-        }
-        char  render[]  = {text[j], 0};
-        g_Conf.m_RenderText(x + pad + dx, y + pad, charWidth, charHeight, render, textColor);
-        dx += charWidth;
-      }
-      
-      if (data.m_Selected)
-      {
-        g_Conf.m_RenderRect(
-          x + pad + (data.m_Cursor - data.m_First) * charWidth,
-          y + pad,
-          g_Conf.m_UITextFieldBar,
-          charHeight,
-          textFieldBarColor
-        );
-      }
+      ++g_TextCacheStats.m_Hits;
+      UnlinkCachedText(index);
+      LinkCachedText(index);
+      return (entry.m_Texture);
     }
   }
+  
+  ++g_TextCacheStats.m_Misses;
+  
+  // measure first so that oversized strings are never rasterized.
+  i32 w {};
+  i32 h {};
+  ++g_FrameStats.m_Measurements;
+  if (TTF_SizeUTF8(font, text, &w, &h))
+  {
+    return (nullptr);
+  }
+  
+  usize bytes   = (usize)w * h * 4;
+  usize budget  = g_PlatformConf.m_TextCacheBudget;
+  if (bytes > budget)
+  {
+    return (nullptr);
+  }
+  
+  while (g_CachedTextTail != NO_TEXT && (g_TextCacheStats.m_Bytes + bytes > budget || !g_CachedTextFreeLength))
+  {
+    EvictCachedText(g_CachedTextTail);
+  }
+  
+  SDL_Surface*  surface = TTF_RenderUTF8_Blended(font, text, DEFAULT_COLORS[color]);
+  ++g_FrameStats.m_Rasterizations;
+  if (!surface)
+  {
+    return (nullptr);
+  }
+  
+  SDL_Texture*  texture = SDL_CreateTextureFromSurface(g_PlatformConf.m_Renderer, surface);
+  SDL_FreeSurface(surface);
+  if (!texture)
+  {
+    return (nullptr);
+  }
+  ++g_FrameStats.m_TexturesCreated;
+  
+  // probing stopped on an empty slot, and eviction only frees slots.
+  slot = CachedTextSlot(font, hash, color);
+  while (g_CachedTextTable[slot])
+  {
+    slot = (slot + 1) & mask;
+  }
+  
+  u16 index = g_CachedTextFree[--g_CachedTextFreeLength];
+  g_CachedTexts[index].m_Font     = font;
+  g_CachedTexts[index].m_Hash     = hash;
+  g_CachedTexts[index].m_Texture  = texture;
+  g_CachedTexts[index].m_Bytes    = bytes;
+  g_CachedTexts[index].m_Color    = color;
+  memcpy(g_CachedTexts[index].m_Text, text, length + 1);
+  g_CachedTextTable[slot] = index + 1;
+  LinkCachedText(index);
+  
+  g_TextCacheStats.m_Bytes += bytes;
+  ++g_TextCacheStats.m_Entries;
+  
+  return (texture);
+}
+#endif
+
 }
 
-void  UIPanel::Label(const char* text)
+namespace Platform
+{
+
+#ifdef ZTGL_SDL2_RENDERER
+void  RenderRect(i32 x, i32 y, i32 w, i32 h, Color color)
 {
-  if (m_ElemsLength >= m_ElemsCapacity)
+  ++Internal::t_FrameStats->m_Rects;
+  if (g_PlatformConf.m_BatchRects)
   {
+    Internal::BatchRect(SDL_Rect{x, y, w, h}, color);
     return;
   }
   
-  i32 w {};
-  i32 h {};
-  TTF_SizeText(m_Font, text, &w, &h);
-  
-  m_Elems[m_ElemsLength].m_Label.m_Type   = Internal::LABEL;
-  m_Elems[m_ElemsLength].m_Label.m_Flags  = Internal::INACTIVE * !m_Active;
-  m_Elems[m_ElemsLength].m_Label.m_X      = m_X;
-  m_Elems[m_ElemsLength].m_Label.m_Y      = m_Y;
-  m_Elems[m_ElemsLength].m_Label.m_W      = w;
-  m_Elems[m_ElemsLength].m_Label.m_H      = h;
-  m_Elems[m_ElemsLength].m_Label.m_Text   = text;
-  ++m_ElemsLength;
+  Internal::FlushSprites();
+  ++Internal::t_FrameStats->m_ColorChanges;
+  ++Internal::t_FrameStats->m_DrawCalls;
+  SDL_SetRenderDrawColor(
+    g_PlatformConf.m_Renderer,
+    DEFAULT_COLORS[color].r,
+    DEFAULT_COLORS[color].g,
+    DEFAULT_COLORS[color].b,
+    DEFAULT_COLORS[color].a
+  );
   
-  if (m_Horizontal)
-  {
-    m_X += w;
-  }
-  else
-  {
-    m_Y += h;
-  }
+  SDL_Rect  r {x, y, w, h};
+  SDL_RenderFillRect(g_PlatformConf.m_Renderer, &r);
+}
+#else
+void  RenderRect(i32 x, i32 y, i32 w, i32 h, Color color)
+{
+  ++Internal::t_FrameStats->m_Rects;
+  SDL_Rect  bounds  {0, 0, g_PlatformConf.m_Width, g_PlatformConf.m_Height};
+  Internal::RecordSoftCmd(SDL_Rect{x, y, w, h}, bounds, 0, 0, Internal::SOFT_RECT, color);
 }
+#endif
 
-bool  UIPanel::Button(const char* text)
+#ifdef ZTGL_SDL2_RENDERER
+void  RenderText(i32 x, i32 y, i32 w, i32 h, const char* text, Color color)
 {
-  if (m_ElemsLength >= m_ElemsCapacity)
+  ++Internal::t_FrameStats->m_Texts;
+  TTF_Font* font  = g_PlatformConf.m_Font;
+  if (!font || !*text)
   {
-    return (false);
+    return;
   }
   
-  bool  state = false;
-  
-  i32 w {};
-  i32 h {};
-  TTF_SizeText(m_Font, text, &w, &h);
-  w += 2 * g_Conf.m_UIPad;
-  h += 2 * g_Conf.m_UIPad;
+  // text goes on top of everything queued so far.
+  Internal::FlushBatches();
+  Internal::UploadGlyphResults(GLYPH_UPLOADS);
   
-  if (m_Active)
+  // whole-string textures, if enabled, take priority over the glyph atlas.
+  if (g_PlatformConf.m_TextCacheBudget)
   {
-    SDL_Point m = MousePos(m_Window);
-    if (MouseReleased(SDL_BUTTON_LEFT) && m.x >= m_X && m.y >= m_Y && m.x < m_X + w && m.y < m_Y + h)
+    SDL_Texture*  texture = Internal::FindCachedText(font, text, color);
+    if (texture)
     {
-      state = true;
+      SDL_Rect  r {x, y, w, h};
+      SDL_RenderCopy(g_PlatformConf.m_Renderer, texture, nullptr, &r);
+      ++Internal::t_FrameStats->m_DrawCalls;
+      return;
     }
   }
   
-  m_Elems[m_ElemsLength].m_Button.m_Type  = Internal::BUTTON;
-  m_Elems[m_ElemsLength].m_Button.m_Flags = Internal::INACTIVE * !m_Active;
-  m_Elems[m_ElemsLength].m_Button.m_X     = m_X;
-  m_Elems[m_ElemsLength].m_Button.m_Y     = m_Y;
-  m_Elems[m_ElemsLength].m_Button.m_W     = w;
-  m_Elems[m_ElemsLength].m_Button.m_H     = h;
-  m_Elems[m_ElemsLength].m_Button.m_Text  = text;
-  ++m_ElemsLength;
-  
-  if (m_Horizontal)
+  if (!Internal::CreateGlyphAtlas())
   {
-    m_X += w;
+    return;
   }
-  else
+  
+  // text is laid out at its natural size, then stretched into the rect.
+  i32 textW = 0;
+  i32 textH = TTF_FontHeight(font);
+  for (const char* c = text; *c;)
   {
-    m_Y += h;
+    const Internal::Glyph*  glyph = Internal::AtlasGlyph(font, Internal::DecodeUTF8(c));
+    textW += glyph ? glyph->m_Advance : 0;
   }
   
-  return (state);
-}
-
-bool  UIPanel::Slider(const char* text, IN_OUT f32& value)
-{
-  if (m_ElemsLength >= m_ElemsCapacity)
+  if (textW <= 0 || textH <= 0)
   {
-    return (false);
+    return;
   }
   
-  bool  state = false;
-  
-  i32 w {};
-  i32 h {};
-  TTF_SizeText(m_Font, text, &w, &h);
-  w += 2 * g_Conf.m_UIPad;
-  h += 2 * g_Conf.m_UIPad;
+  f32 sx  = (f32)w / textW;
+  f32 sy  = (f32)h / textH;
   
-  if (m_Active)
+  i32 penX  = 0;
+  for (const char* c = text; *c;)
   {
-    SDL_Point m = MousePos(m_Window);
-    
-    if (MouseReleased(SDL_BUTTON_LEFT) && m.x >= m_X && m.y >= m_Y && m.x < m_X + w && m.y < m_Y + h)
+    const Internal::Glyph*  glyph = Internal::AtlasGlyph(font, Internal::DecodeUTF8(c));
+    if (!glyph)
     {
-      value = (f32)(m.x - m_X) / w;
-      state = true;
+      continue;
     }
     
-    value = value < 0.0f ? 0.0f : value;
-    value = value > 1.0f ? 1.0f : value;
-  }
-  
-  m_Elems[m_ElemsLength].m_Slider.m_Type  = Internal::SLIDER;
-  m_Elems[m_ElemsLength].m_Slider.m_Flags = Internal::INACTIVE * !m_Active;
-  m_Elems[m_ElemsLength].m_Slider.m_X     = m_X;
-  m_Elems[m_ElemsLength].m_Slider.m_Y     = m_Y;
-  m_Elems[m_ElemsLength].m_Slider.m_W     = w;
-  m_Elems[m_ElemsLength].m_Slider.m_H     = h;
-  m_Elems[m_ElemsLength].m_Slider.m_Text  = text;
-  m_Elems[m_ElemsLength].m_Slider.m_Value = value;
-  ++m_ElemsLength;
-  
-  if (m_Horizontal)
-  {
-    m_X += w;
-  }
-  else
-  {
-    m_Y += h;
+    Internal::PushGlyphQuad(*glyph, x + penX * sx, y, sx, sy, color);
+    penX += glyph->m_Advance;
   }
   
-  return (state);
+  Internal::FlushText();
 }
-
-// text field assumes that m_Font is loaded with monospace font
-bool  UIPanel::TextField(const char* text, IN_OUT TFData& data, u32 nDraw)
+#else
+void  RenderText(i32 x, i32 y, i32 w, i32 h, const char* text, Color color)
 {
-  if (m_ElemsLength >= m_ElemsCapacity)
+  ++Internal::t_FrameStats->m_Texts;
+  TTF_Font* font  = g_PlatformConf.m_Font;
+  if (!font)
   {
-    return (false);
+    return;
   }
   
-  bool  state = false;
-  
-  i32 charWidth   {};
-  i32 charHeight  {};
-  TTF_SizeText(m_Font, " ", &charWidth, &charHeight);
-  
-  i32 w = nDraw * charWidth + 2 * g_Conf.m_UIPad;
-  i32 h = charHeight + 2 *g_Conf.m_UIPad;
+  // glyphs are drawn at their natural size, clipped to the text rect.
+  Internal::UploadGlyphResults(GLYPH_UPLOADS);
+  SDL_Rect  bounds  {0, 0, g_PlatformConf.m_Width, g_PlatformConf.m_Height};
+  if (!Internal::ClipRect(bounds, SDL_Rect{x, y, w, h}))
+  {
+    return;
+  }
   
-  if (m_Active)
+  i32 penX  = x;
+  for (const char* c = text; *c && penX < bounds.x + bounds.w;)
   {
-    if (MouseReleased(SDL_BUTTON_LEFT))
+    const Internal::Glyph*  glyph = Internal::AtlasGlyph(font, Internal::DecodeUTF8(c));
+    if (!glyph)
     {
-      SDL_Point m = MousePos(m_Window);
-      if (m.x >= m_X && m.y >= m_Y && m.x < m_X + w && m.y < m_Y + h)
-      {
-        data.m_Selected = true;
-      }
-      else
-      {
-        data.m_Selected = false;
-      }
+      continue;
     }
     
-    if (data.m_Selected)
+    if (glyph->m_W && glyph->m_H)
     {
-      if (KeyPressed(SDLK_LEFT))
-      {
-        data.m_Cursor -= data.m_Cursor > 0;
-        data.m_First -= data.m_Cursor < data.m_First;
-      }
-      
-      if (KeyPressed(SDLK_RIGHT))
-      {
-        data.m_Cursor += data.m_Cursor < data.m_Length;
-        data.m_First += data.m_Cursor - data.m_First >= nDraw;
-      }
-      
-      if (KeyPressed(SDLK_UP))
-      {
-        data.m_Cursor = 0;
-        data.m_First = 0;
-      }
-      
-      if (KeyPressed(SDLK_DOWN))
-      {
-        data.m_Cursor = data.m_Length;
-        data.m_First = 0;
-        while (data.m_Cursor - data.m_First > nDraw)
-        {
-          ++data.m_First;
-        }
-      }
-      
-      for (u8 i = 0; data.m_Length + 1 < data.m_Capacity && i < 128; ++i)
-      {
-        if (!isprint(i))
-        {
-          continue;
-        }
-        
-        if (TextInput(i))
-        {
-          state = true;
-          
-          memmove(
-            &data.m_Buffer[data.m_Cursor + 1],
-            &data.m_Buffer[data.m_Cursor],
-            data.m_Length - data.m_Cursor
-          );
-          
-          ++data.m_Cursor;
-          data.m_First += data.m_Cursor - data.m_First >= nDraw;
-          
-          data.m_Buffer[data.m_Cursor - 1] = i;
-          ++data.m_Length;
-          data.m_Buffer[data.m_Length] = 0;
-        }
-      }
-      
-      if (KeyPressed(SDLK_BACKSPACE) && data.m_Cursor)
-      {
-        state = true;
-        
-        memmove(
-          &data.m_Buffer[data.m_Cursor - 1],
-          &data.m_Buffer[data.m_Cursor],
-          data.m_Length - data.m_Cursor
-        );
-        
-        --data.m_Cursor;
-        data.m_First -= data.m_Cursor < data.m_First;
-        
-        --data.m_Length;
-        data.m_Buffer[data.m_Length] = 0;
-      }
+      Internal::RecordSoftCmd(
+        SDL_Rect{penX, y, glyph->m_W, glyph->m_H},
+        bounds,
+        glyph->m_X - penX,
+        glyph->m_Y - y,
+        Internal::SOFT_GLYPH,
+        color
+      );
     }
+    
+    penX += glyph->m_Advance;
   }
-  
-  m_Elems[m_ElemsLength].m_TextField.m_Type   = Internal::TEXT_FIELD;
-  m_Elems[m_ElemsLength].m_TextField.m_Flags  = Internal::INACTIVE * !m_Active;
-  m_Elems[m_ElemsLength].m_TextField.m_X      = m_X;
-  m_Elems[m_ElemsLength].m_TextField.m_Y      = m_Y;
-  m_Elems[m_ElemsLength].m_TextField.m_W      = w;
-  m_Elems[m_ElemsLength].m_TextField.m_H      = h;
-  m_Elems[m_ElemsLength].m_TextField.m_Text   = text;
-  m_Elems[m_ElemsLength].m_TextField.m_TFData = &data;
-  m_Elems[m_ElemsLength].m_TextField.m_NDraw  = nDraw;
-  ++m_ElemsLength;
-  
-  if (m_Horizontal)
-  {
-    m_X += w;
-  }
-  else
-  {
-    m_Y += h;
-  }
-  
-  return (state);
 }
+#endif
 
-bool  UIPanel::HoldButton(const char* text)
+// draws each codepoint of text[0, length) into its own advance * h cell.
+#ifdef ZTGL_SDL2_RENDERER
+void  RenderTextRun(i32 x, i32 y, i32 advance, i32 h, const char* text, usize length, Color color)
 {
-  if (m_ElemsLength >= m_ElemsCapacity)
+  ++Internal::t_FrameStats->m_Texts;
+  TTF_Font* font  = g_PlatformConf.m_Font;
+  if (!font || !length)
   {
-    return (false);
+    return;
   }
   
-  bool  state = false;
-  
-  i32 w {};
-  i32 h {};
-  TTF_SizeText(m_Font, text, &w, &h);
-  w += 2 * g_Conf.m_UIPad;
-  h += 2 * g_Conf.m_UIPad;
-  
-  if (m_Active)
+  Internal::FlushBatches();
+  Internal::UploadGlyphResults(GLYPH_UPLOADS);
+  if (!Internal::CreateGlyphAtlas())
   {
-    SDL_Point m = MousePos(m_Window);
-    if (MouseReleased(SDL_BUTTON_LEFT) && m.x >= m_X && m.y >= m_Y && m.x < m_X + w && m.y < m_Y + h)
-    {
-      state = true;
-    }
+    return;
   }
   
-  m_Elems[m_ElemsLength].m_Button.m_Type  = Internal::HOLD_BUTTON;
-  m_Elems[m_ElemsLength].m_Button.m_Flags = Internal::INACTIVE * !m_Active;
-  m_Elems[m_ElemsLength].m_Button.m_X     = m_X;
-  m_Elems[m_ElemsLength].m_Button.m_Y     = m_Y;
-  m_Elems[m_ElemsLength].m_Button.m_W     = w;
-  m_Elems[m_ElemsLength].m_Button.m_H     = h;
-  m_Elems[m_ElemsLength].m_Button.m_Text  = text;
-  ++m_ElemsLength;
-  
-  if (m_Horizontal)
+  i32 textH = TTF_FontHeight(font);
+  if (textH <= 0)
   {
-    m_X += w;
+    return;
   }
-  else
+  
+  f32         sy  = (f32)h / textH;
+  const char* end = text + length;
+  for (i32 penX = x; text < end; penX += advance)
   {
-    m_Y += h;
+    const Internal::Glyph*  glyph = Internal::AtlasGlyph(font, Internal::DecodeUTF8(text));
+    if (!glyph || glyph->m_Advance <= 0)
+    {
+      continue;
+    }
+    
+    Internal::PushGlyphQuad(*glyph, penX, y, (f32)advance / glyph->m_Advance, sy, color);
   }
   
-  return (state);
-}
-
-//-------------------//
-// memory management //
-//-------------------//
-
-void* BumpAllocator::Alloc(usize n)
-{
-  u8* allocation  = &m_Buffer[m_Length];
-  m_Length += n;
-  m_Length = Align(m_Length, MEMORY_ALIGN);
-  
-  u8* actual  = m_Length > m_Capacity ? nullptr : allocation;
-  return (actual);
-}
-
-void  BumpAllocator::Reset()
-{
-  memset(m_Buffer, 0, m_Capacity);
-  m_Length = 0;
-}
-
-BumpAllocator::BumpAllocator(u8* buffer, usize capacity)
-  : m_Buffer(buffer),
-  m_Capacity(capacity)
-{
-  memset(m_Buffer, 0, m_Capacity);
+  Internal::FlushText();
 }
-
-void* ArrayAllocator::Alloc(usize n)
+#else
+void  RenderTextRun(i32 x, i32 y, i32 advance, i32 h, const char* text, usize length, Color color)
 {
-  if (m_AllocationsLength >= m_AllocationsCapacity)
+  ++Internal::t_FrameStats->m_Texts;
+  TTF_Font* font  = g_PlatformConf.m_Font;
+  if (!font)
   {
-    return (nullptr);
+    return;
   }
   
-  for (usize i = 0; i < m_AllocationsLength; ++i)
+  Internal::UploadGlyphResults(GLYPH_UPLOADS);
+  const char* end = text + length;
+  for (i32 penX = x; text < end; penX += advance)
   {
-    usize offset  = m_Allocations[i].m_Offset + m_Allocations[i].m_Length;
-    offset = Align(offset, MEMORY_ALIGN);
-    
-    if (!RegionFree(offset, n))
+    const Internal::Glyph*  glyph = Internal::AtlasGlyph(font, Internal::DecodeUTF8(text));
+    if (!glyph || !glyph->m_W || !glyph->m_H)
     {
       continue;
     }
     
-    if (offset + n > m_BufferCapacity)
+    SDL_Rect  cell  {0, 0, g_PlatformConf.m_Width, g_PlatformConf.m_Height};
+    if (!Internal::ClipRect(cell, SDL_Rect{penX, y, advance, h}))
     {
       continue;
     }
     
-    m_Allocations[m_AllocationsLength].m_Offset = offset;
-    m_Allocations[m_AllocationsLength].m_Length = n;
-    ++m_AllocationsLength;
-    return (&m_Buffer[offset]);
+    Internal::RecordSoftCmd(
+      SDL_Rect{penX, y, glyph->m_W, glyph->m_H},
+      cell,
+      glyph->m_X - penX,
+      glyph->m_Y - y,
+      Internal::SOFT_GLYPH,
+      color
+    );
   }
-  
-  return (nullptr);
 }
+#endif
 
-void  ArrayAllocator::Free(void* pointer)
+#ifdef ZTGL_SDL2_RENDERER
+void  RenderRects(const SDL_Rect rects[], usize n, Color color)
 {
-  (void)pointer;
+  Internal::t_FrameStats->m_Rects += n;
+  if (g_PlatformConf.m_BatchRects)
+  {
+    for (usize i = 0; i < n; ++i)
+    {
+      Internal::BatchRect(rects[i], color);
+    }
+    return;
+  }
   
-  // TODO: implement
-}
-
-void* ArrayAllocator::Realloc(void* pointer, usize n)
-{
-  (void)pointer, (void)n;
-  return (nullptr);
+  Internal::FlushSprites();
+  ++Internal::t_FrameStats->m_ColorChanges;
+  ++Internal::t_FrameStats->m_DrawCalls;
+  SDL_SetRenderDrawColor(
+    g_PlatformConf.m_Renderer,
+    DEFAULT_COLORS[color].r,
+    DEFAULT_COLORS[color].g,
+    DEFAULT_COLORS[color].b,
+    DEFAULT_COLORS[color].a
+  );
   
-  // TODO: implement
+  SDL_RenderFillRects(g_PlatformConf.m_Renderer, rects, n);
 }
-
-bool  ArrayAllocator::RegionFree(usize offset, usize length)
+#else
+void  RenderRects(const SDL_Rect rects[], usize n, Color color)
 {
-  for (usize i = 0; i < m_AllocationsLength; ++i)
+  for (usize i = 0; i < n; ++i)
   {
-    bool  noOverlapLeft   = offset + length < m_Allocations[i].m_Offset;
-    bool  noOverlapRight  = offset >= m_Allocations[i].m_Offset + m_Allocations[i].m_Length;
-    bool  noOverlap       = noOverlapLeft || noOverlapRight;
-    
-    if (!noOverlap)
-    {
-      return (false);
-    }
+    RenderRect(rects[i].x, rects[i].y, rects[i].w, rects[i].h, color);
   }
-  return (true);
 }
+#endif
 
-void  ArrayAllocator::Reset()
+// sprites are always queued, until Flush() or anything else is drawn.
+#ifdef ZTGL_SDL2_RENDERER
+void  RenderSprite(const Sprite& sprite)
 {
-  memset(m_Buffer, 0, m_BufferCapacity);
-  m_AllocationsLength = 0;
+  ++Internal::t_FrameStats->m_Sprites;
+  Internal::BatchSprite(sprite);
 }
-
-ArrayAllocator::ArrayAllocator(u8* buffer, usize bufferCapacity, Allocation* allocations, usize allocationsCapacity)
-  : m_Buffer(buffer),
-  m_BufferCapacity(bufferCapacity),
-  m_Allocations(allocations),
-  m_AllocationsCapacity(allocationsCapacity)
+#else
+void  RenderSprite(const Sprite& sprite)
 {
-  memset(m_Buffer, 0, m_BufferCapacity);
+  (void)sprite;
+  
+  // textures only exist on the SDL renderer.
 }
+#endif
 
-//------//
-// util //
-//------//
-
-void  Error(const char* format, ...)
+#ifdef ZTGL_SDL2_RENDERER
+void  RenderSprites(const Sprite sprites[], usize n)
 {
-  va_list args  {};
-  va_start(args, format);
-  
-  char  msg[512]  = {0};
-  vsnprintf(msg, sizeof(msg), format, args);
-  
-  if (SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, g_Conf.m_ErrorTitle, msg, nullptr))
+  Internal::t_FrameStats->m_Sprites += n;
+  for (usize i = 0; i < n; ++i)
   {
-    fprintf(g_Conf.m_Log, "\x1b[1;31merr\x1b[0m: %s\n", msg);
+    Internal::BatchSprite(sprites[i]);
   }
-  
-  va_end(args);
 }
-
-u64 UnixMicro()
+#else
+void  RenderSprites(const Sprite sprites[], usize n)
 {
-  timeval timeData  {};
-  gettimeofday(&timeData, nullptr);
-  u64 microTime = (u64)timeData.tv_sec * 1000000 + (u64)timeData.tv_usec;
-  return (microTime);
+  (void)sprites;
+  (void)n;
 }
+#endif
 
-void  BeginTick()
+#ifdef ZTGL_SDL2_RENDERER
+void  SetClip(const SDL_Rect* clip)
 {
-  Internal::g_TickStart = UnixMicro();
+  // queued draws were submitted under the previous clip.
+  Internal::FlushBatches();
+  SDL_RenderSetClipRect(g_PlatformConf.m_Renderer, clip);
 }
-
-void  EndTick()
+#else
+void  SetClip(const SDL_Rect* clip)
 {
-  u64 tickEnd   = UnixMicro();
-  i64 timeLeft  = g_Conf.m_TickMicro - tickEnd + Internal::g_TickStart;
-  timeLeft *= timeLeft > 0;
-  
-  SDL_Delay(timeLeft / 1000);
+  // commands are clipped as they are recorded, so nothing to flush.
+  Internal::g_SoftClipped = clip;
+  Internal::g_SoftClip = clip ? *clip : SDL_Rect{};
 }
+#endif
 
-void  BeginTimer(OUT u64& timer)
+#ifdef ZTGL_SDL2_RENDERER
+void  Flush()
 {
-  timer = UnixMicro();
+  Internal::FlushBatches();
 }
-
-void  EndTimer(u64 timer, const char* name)
+#else
+void  Flush()
 {
-  u64 d = UnixMicro() - timer;
-  fprintf(g_Conf.m_Log, "\x1b[1;33mtimer\x1b[0m: %s: %llu\n", name, (unsigned long long)d);
+  Internal::FlushText();
 }
+#endif
 
-f32 InterpAngle(f32 a, f32 b, f32 t)
+// SDL_ttf fonts must not be used from two threads at once, so the worker
+// rasterizes with workerFont, a second handle opened on the same face and
+// size, and the glyphs are filed under font. passing nullptr as workerFont
+// uses font itself, which must then stay untouched until nothing is pending.
+// returns false if only part of the text could be queued.
+bool  PrerasterizeText(TTF_Font* font, TTF_Font* workerFont, const char* const strings[], usize n)
 {
-  f32 interpolated  = (a + ShortestAngle(a, b) * t);
-  return (interpolated);
+  if (!Internal::StartGlyphWorker())
+  {
+    return (false);
+  }
+  
+  // consecutive codepoints are merged into ranges.
+  Internal::GlyphJob  job {font, workerFont ? workerFont : font, 1, 0};
+  for (usize i = 0; i < n; ++i)
+  {
+    for (const char* c = strings[i]; *c;)
+    {
+      u32   cp    = Internal::DecodeUTF8(c);
+      usize slot  {};
+      if (Internal::FindGlyph(font, cp, slot))
+      {
+        continue;
+      }
+      
+      if (job.m_First <= job.m_Last && cp == job.m_Last + 1)
+      {
+        ++job.m_Last;
+        continue;
+      }
+      
+      if (job.m_First <= job.m_Last && !Internal::PushGlyphJob(job))
+      {
+        return (false);
+      }
+      
+      job.m_First = cp;
+      job.m_Last = cp;
+    }
+  }
+  
+  bool  pushed  = job.m_First > job.m_Last || Internal::PushGlyphJob(job);
+  return (pushed);
 }
 
-f32 ShortestAngle(f32 a, f32 b)
+bool  PrerasterizeRange(TTF_Font* font, TTF_Font* workerFont, u32 first, u32 last)
 {
-  f32 d         = fmod(b - a, TAU);
-  f32 shortest  = fmod(2.0f * d, TAU) - d;
-  return (shortest);
+  if (first > last || !Internal::StartGlyphWorker())
+  {
+    return (false);
+  }
+  
+  bool  pushed  = Internal::PushGlyphJob(Internal::GlyphJob{font, workerFont ? workerFont : font, first, last});
+  return (pushed);
 }
 
-f32 Degrees(f32 rad)
+// text drawing already uploads a few glyphs per call, this drains the rest.
+usize UploadGlyphs()
 {
-  return (rad / PI * 180.0f);
+  usize n = Internal::UploadGlyphResults(SIZE_MAX);
+  return (n);
 }
 
-f32 Radians(f32 deg)
+bool  PrerasterizePending()
 {
-  return (deg / 180.0f * PI);
+  bool  pending = SDL_AtomicGet(&Internal::g_GlyphsInFlight) > 0;
+  return (pending);
 }
 
-void* AllocBatch(IN_OUT AllocBatchDesc allocs[], usize nAllocs)
+#ifdef ZTGL_SDL2_RENDERER
+bool  BeginPanelCache(IN_OUT PanelCache& cache, i32 w, i32 h)
 {
-  usize size  = 0;
-  for (usize i = 0; i < nAllocs; ++i)
+  if (w <= 0 || h <= 0)
   {
-    size += allocs[i].m_Count * allocs[i].m_Size;
-    size = Align(size, MEMORY_ALIGN);
+    return (false);
   }
   
-  u8* p = (u8*)malloc(size);
-  if (!p)
+  if (!cache.m_Texture || cache.m_W != w || cache.m_H != h)
   {
-    return (nullptr);
+    ReleasePanelCache(cache);
+    cache.m_Texture = SDL_CreateTexture(
+      g_PlatformConf.m_Renderer,
+      SDL_PIXELFORMAT_ARGB8888,
+      SDL_TEXTUREACCESS_TARGET,
+      w,
+      h
+    );
+    
+    if (!cache.m_Texture)
+    {
+      return (false);
+    }
+    
+    ++Internal::t_FrameStats->m_TexturesCreated;
+    cache.m_W = w;
+    cache.m_H = h;
   }
   
-  usize offset  = 0;
-  for (usize i = 0; i < nAllocs; ++i)
+  // with blending, the target ends up holding premultiplied color, so it
+  // has to be composited as such. otherwise it is copied as is.
+  SDL_BlendMode mode  {};
+  SDL_GetRenderDrawBlendMode(g_PlatformConf.m_Renderer, &mode);
+  if (mode == SDL_BLENDMODE_BLEND)
   {
-    *allocs[i].m_Pointer = &p[offset];
-    offset += allocs[i].m_Count * allocs[i].m_Size;
-    offset = Align(offset, MEMORY_ALIGN);
+    mode = SDL_ComposeCustomBlendMode(
+      SDL_BLENDFACTOR_ONE,
+      SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+      SDL_BLENDOPERATION_ADD,
+      SDL_BLENDFACTOR_ONE,
+      SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+      SDL_BLENDOPERATION_ADD
+    );
   }
-  
-  return (p);
-}
-
-void* ReallocBatch(void* p, IN_OUT ReallocBatchDesc reallocs[], usize nReallocs)
-{
-  usize*  oldOffsets  = (usize*)calloc(nReallocs, sizeof(usize));
-  usize*  newOffsets  = (usize*)calloc(nReallocs, sizeof(usize));
-  
-  usize newSize = 0;
-  usize oldSize = 0;
-  for (usize i = 0; i < nReallocs; ++i)
+  else
   {
-    newOffsets[i] = newSize;
-    newSize += reallocs[i].m_NewCount * reallocs[i].m_Size;
-    newSize = Align(newSize, MEMORY_ALIGN);
-    
-    oldOffsets[i] = oldSize;
-    oldSize += reallocs[i].m_OldCount * reallocs[i].m_Size;
-    oldSize = Align(oldSize, MEMORY_ALIGN);
+    mode = SDL_BLENDMODE_NONE;
   }
   
-  p = realloc(p, newSize);
-  if (!p)
+  // a renderer without premultiplied blending can't composite the cache.
+  if (mode == SDL_BLENDMODE_INVALID || SDL_SetTextureBlendMode(cache.m_Texture, mode))
   {
-    free(oldOffsets);
-    free(newOffsets);
-    return (nullptr);
+    return (false);
   }
   
-  u8* up  = (u8*)p;
-  for (isize i = nReallocs - 1; i >= 0; --i)
+  Internal::FlushBatches();
+  Internal::g_PanelCachePrevTarget = SDL_GetRenderTarget(g_PlatformConf.m_Renderer);
+  if (SDL_SetRenderTarget(g_PlatformConf.m_Renderer, cache.m_Texture))
   {
-    usize newBytes  = reallocs[i].m_NewCount * reallocs[i].m_Size;
-    usize oldBytes  = reallocs[i].m_OldCount * reallocs[i].m_Size;
-    usize bytes     = newBytes < oldBytes ? newBytes : oldBytes;
-    
-    memmove(&up[newOffsets[i]], &up[oldOffsets[i]], bytes);
-    *reallocs[i].m_Pointer = &up[newOffsets[i]];
+    return (false);
   }
   
-  free(oldOffsets);
-  free(newOffsets);
-  return (p);
+  u8  r {};
+  u8  g {};
+  u8  b {};
+  u8  a {};
+  SDL_GetRenderDrawColor(g_PlatformConf.m_Renderer, &r, &g, &b, &a);
+  SDL_SetRenderDrawColor(g_PlatformConf.m_Renderer, 0, 0, 0, 0);
+  SDL_RenderClear(g_PlatformConf.m_Renderer);
+  SDL_SetRenderDrawColor(g_PlatformConf.m_Renderer, r, g, b, a);
+  ++Internal::t_FrameStats->m_DrawCalls;
+  
+  return (true);
 }
-
-u64 Align(u64 addr, u64 align)
+#else
+bool  BeginPanelCache(IN_OUT PanelCache& cache, i32 w, i32 h)
 {
-  return (addr + align - addr % align);
+  (void)cache;
+  (void)w;
+  (void)h;
+  
+  return (false);
 }
+#endif
 
-//-------------------------------//
-// platform-dependent procedures //
-//-------------------------------//
-
-namespace Platform
+#ifdef ZTGL_SDL2_RENDERER
+void  EndPanelCache(const PanelCache& cache)
+{
+  (void)cache;
+  
+  Internal::FlushBatches();
+  SDL_SetRenderTarget(g_PlatformConf.m_Renderer, Internal::g_PanelCachePrevTarget);
+  Internal::g_PanelCachePrevTarget = nullptr;
+}
+#else
+void  EndPanelCache(const PanelCache& cache)
 {
+  (void)cache;
+}
+#endif
 
 #ifdef ZTGL_SDL2_RENDERER
-void  RenderRect(i32 x, i32 y, i32 w, i32 h, Color color)
+void  RenderPanelCache(const PanelCache& cache, i32 x, i32 y)
 {
-  SDL_SetRenderDrawColor(
-    g_PlatformConf.m_Renderer,
-    DEFAULT_COLORS[color].r,
-    DEFAULT_COLORS[color].g,
-    DEFAULT_COLORS[color].b,
-    DEFAULT_COLORS[color].a
-  );
+  Internal::FlushBatches();
   
-  SDL_Rect  r {x, y, w, h};
-  SDL_RenderFillRect(g_PlatformConf.m_Renderer, &r);
+  SDL_Rect  src {0, 0, cache.m_W, cache.m_H};
+  SDL_Rect  dst {x, y, cache.m_W, cache.m_H};
+  SDL_RenderCopy(g_PlatformConf.m_Renderer, cache.m_Texture, &src, &dst);
+  ++Internal::t_FrameStats->m_DrawCalls;
 }
 #else
-void  RenderRect(i32 x, i32 y, i32 w, i32 h, Color color)
+void  RenderPanelCache(const PanelCache& cache, i32 x, i32 y)
 {
+  (void)cache;
+  (void)x;
+  (void)y;
 }
 #endif
 
 #ifdef ZTGL_SDL2_RENDERER
-void  RenderText(i32 x, i32 y, i32 w, i32 h, const char* text, Color color)
+void  ReleasePanelCache(IN_OUT PanelCache& cache)
 {
-  SDL_Color rgba  {DEFAULT_COLORS[color].r, DEFAULT_COLORS[color].g, DEFAULT_COLORS[color].b, DEFAULT_COLORS[color].a};
+  if (cache.m_Texture)
+  {
+    SDL_DestroyTexture(cache.m_Texture);
+  }
   
-  SDL_Surface*  surface = TTF_RenderUTF8_Solid(g_PlatformConf.m_Font, text, rgba);
-  if (!surface)
+  cache = PanelCache{};
+}
+#else
+void  ReleasePanelCache(IN_OUT PanelCache& cache)
+{
+  cache = PanelCache{};
+}
+#endif
+
+#ifdef ZTGL_SDL2_RENDERER
+void  ReleaseResources()
+{
+  if (Internal::g_GlyphAtlas)
   {
-    return;
+    SDL_DestroyTexture(Internal::g_GlyphAtlas);
+    Internal::g_GlyphAtlas = nullptr;
+    Internal::g_GlyphAtlasRenderer = nullptr;
   }
   
-  SDL_Texture*  texture = SDL_CreateTextureFromSurface(g_PlatformConf.m_Renderer, surface);
-  SDL_FreeSurface(surface);
-  if (!texture)
+  Internal::ClearTextCache();
+  Internal::g_TextCacheRenderer = nullptr;
+  Internal::StopGlyphWorker();
+  ForgetFonts();
+}
+#else
+void  ReleaseResources()
+{
+  Internal::g_SoftCmdsLength = 0;
+  Internal::StopRasterWorkers();
+  if (Internal::g_RasterDone)
   {
-    return;
+    SDL_DestroySemaphore(Internal::g_RasterDone);
+    Internal::g_RasterDone = nullptr;
   }
   
-  SDL_Rect  r {x, y, w, h};
-  SDL_RenderCopy(g_PlatformConf.m_Renderer, texture, nullptr, &r);
-  SDL_DestroyTexture(texture);
+  Internal::StopGlyphWorker();
+  Internal::ResetGlyphAtlas();
+  ForgetFonts();
+}
+#endif
+
+#ifdef ZTGL_SDL2_RENDERER
+TextCacheStats  GetTextCacheStats()
+{
+  return (Internal::g_TextCacheStats);
 }
 #else
-void  RenderText(i32 x, i32 y, i32 w, i32 h, const char* text, Color color)
+TextCacheStats  GetTextCacheStats()
+{
+  return (TextCacheStats{});
+}
+#endif
+
+#ifdef ZTGL_SDL2_RENDERER
+void  ResetTextCacheStats()
+{
+  Internal::g_TextCacheStats.m_Hits = 0;
+  Internal::g_TextCacheStats.m_Misses = 0;
+  Internal::g_TextCacheStats.m_Evictions = 0;
+}
+#else
+void  ResetTextCacheStats()
 {
 }
 #endif